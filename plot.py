@@ -2,19 +2,59 @@ import yaml
 import matplotlib.pyplot as plt
 import numpy as np
 
-data = yaml.load(open("perf.dat"))
+data = yaml.safe_load(open("perf.dat"))
 
-benchmarks = {
-    key: [] for key in set([bm["run_name"].split("/")[0] for bm in data["benchmarks"]])
+
+def parse(run_name):
+    # "name/arg1/arg2/real_time" -> ("name", [arg1, arg2]), suffixes are dropped
+    name, *args = run_name.split("/")
+    return name, [int(a) for a in args if a.isdigit()]
+
+
+# benchmarks whose only argument is the number of particles; others take a kill
+# percentage, a thread count or several arguments and are skipped; template
+# arguments are ignored, so "process_span_log<LogAccuracy::low>" is process_span_log
+particle_sweeps = {
+    "charge_span",
+    "filtered_energy_loss",
+    "filtered_energy_loss_declared",
+    "masked_energy_loss",
+    "process_one",
+    "process_one_padded",
+    "process_span",
+    "process_span_aosoa",
+    "process_span_fixed",
+    "process_span_log",
+    "process_span_no_eigen",
+    "process_span_padded",
+    "process_span_realistic",
+    "process_span_simd",
+    "process_span_soa",
+    "process_span_soa_log",
+    "rng_mt19937_one",
+    "rng_philox_span",
+    "static_process_one",
+    "static_process_span_tiled",
+    "variant_process_one",
+    "variant_process_span",
+    "variant_process_span_hybrid",
+    "variant_process_span_no_eigen",
+    "variant_process_span_partitioned",
 }
 
+runs = [
+    (name, args[0], bm)
+    for name, args, bm in (parse(bm["run_name"]) + (bm,) for bm in data["benchmarks"])
+    if name.split("<")[0] in particle_sweeps and len(args) == 1 and 1 <= args[0] <= 10000
+]
+
+benchmarks = {key: [] for key in set(name for name, _, _ in runs)}
+
 for key in benchmarks:
     xlist = []
     ylist = []
     elist = []
-    for bm in data["benchmarks"]:
-        name, n = bm["run_name"].split("/")
-        x = int(n)
+    for name, x, bm in runs:
         if name != key or bm["run_type"] != "aggregate":
             continue
         if bm["aggregate_name"] == "mean":
@@ -36,9 +76,11 @@ plt.xlabel(r"$N_\mathrm{particles}$")
 plt.ylabel("CPU time / ns")
 
 plt.figure()
-yn = benchmarks["variant_process_span_no_eigen"][1]
+xn, yn, en = benchmarks["variant_process_span_no_eigen"]
 for key in sorted(benchmarks):
     (x, y, e) = benchmarks[key]
+    if not np.array_equal(x, xn):  # other ranges cannot be normalised
+        continue
     fmt = "D-" if "variant" in key else "o--"
     plt.errorbar(x, y/yn, e/yn, fmt=fmt, label=key)
 plt.loglog()
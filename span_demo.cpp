@@ -4,7 +4,35 @@
 #include <variant>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 #include <random>
+#include <tuple>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <deque>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <filesystem>
+#include <system_error>
+#include <experimental/simd>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace stdx = std::experimental;
 
 // must have size divisible by size of float and should be trivial for performance
 struct Particle {
@@ -20,6 +48,18 @@ struct Particle {
   float& z() { return z_; }
   float& t() { return t_; }
 
+  std::int32_t pid() const { return pid_; }
+
+  float px() const { return px_; }
+  float py() const { return py_; }
+  float pz() const { return pz_; }
+  float e() const { return e_; }
+
+  float x() const { return x_; }
+  float y() const { return y_; }
+  float z() const { return z_; }
+  float t() const { return t_; }
+
   // "private" variables
   std::int32_t pid_;
   float px_, py_, pz_, e_;
@@ -32,48 +72,830 @@ static_assert(std::is_trivial<Particle>::value);
 // size of Particle must be multiple of size of float for Eigen::Map to work
 static_assert(sizeof(Particle) % sizeof(float) == 0);
 
-template <class T>
+// set of Particle fields, used by processes to declare what they read and write
+using FieldSet = std::uint32_t;
+
+namespace fields {
+constexpr FieldSet pid = 1 << 0;
+constexpr FieldSet px = 1 << 1;
+constexpr FieldSet py = 1 << 2;
+constexpr FieldSet pz = 1 << 3;
+constexpr FieldSet e = 1 << 4;
+constexpr FieldSet x = 1 << 5;
+constexpr FieldSet y = 1 << 6;
+constexpr FieldSet z = 1 << 7;
+constexpr FieldSet t = 1 << 8;
+constexpr FieldSet momentum = px | py | pz;
+constexpr FieldSet position = x | y | z;
+constexpr FieldSet all = pid | momentum | e | position | t;
+} // namespace fields
+
+// Particle padded to a full cache line, so that no particle straddles two lines;
+// the spare slots can hold bookkeeping data
+struct alignas(64) PaddedParticle {
+  std::int32_t& pid() { return pid_; }
+
+  float& px() { return px_; }
+  float& py() { return py_; }
+  float& pz() { return pz_; }
+  float& e() { return e_; }
+
+  float& x() { return x_; }
+  float& y() { return y_; }
+  float& z() { return z_; }
+  float& t() { return t_; }
+
+  float& weight() { return weight_; }
+  std::int32_t& parent() { return parent_; }
+
+  // "private" variables
+  std::int32_t pid_;
+  float px_, py_, pz_, e_;
+  float x_, y_, z_, t_;
+  float weight_;
+  std::int32_t parent_;
+};
+
+static_assert(std::is_trivial<PaddedParticle>::value);
+static_assert(sizeof(PaddedParticle) == 64);
+
+// strided view of one field of P; a const T gives a read-only view; the maps are
+// unaligned, since Eigen does no packet access for an inner stride other than 1, so
+// an alignment hint would have no effect, not even for PaddedParticle
+template <class T, class P = Particle>
 using ArrayView = Eigen::Map<
-    Eigen::Array<T, Eigen::Dynamic, 1>,
+    std::conditional_t<std::is_const<T>::value,
+                       const Eigen::Array<std::remove_const_t<T>, Eigen::Dynamic, 1>,
+                       Eigen::Array<T, Eigen::Dynamic, 1>>,
     Eigen::Unaligned,
-    Eigen::InnerStride<(sizeof(Particle) / sizeof(float))>
+    Eigen::InnerStride<(sizeof(P) / sizeof(float))>
 >;
 
-class ParticleSpan {
+// view of N consecutive particles, with compile-time sized Eigen maps, so that Eigen
+// can skip size checks and fully unroll the kernels
+template <class P, int N>
+class FixedParticleSpan {
+public:
+    template <class T>
+    using FieldView = Eigen::Map<
+        Eigen::Array<T, N, 1>,
+        Eigen::Unaligned,
+        Eigen::InnerStride<(sizeof(P) / sizeof(float))>
+    >;
+
+    explicit FixedParticleSpan(P* b) : begin_(b) {};
+
+    static constexpr std::size_t size() { return N; }
+
+    auto pid() { return FieldView<std::int32_t>(&begin_->pid_); }
+    auto px() { return FieldView<float>(&begin_->px_); }
+    auto py() { return FieldView<float>(&begin_->py_); }
+    auto pz() { return FieldView<float>(&begin_->pz_); }
+    auto e() { return FieldView<float>(&begin_->e_); }
+    auto x() { return FieldView<float>(&begin_->x_); }
+    auto y() { return FieldView<float>(&begin_->y_); }
+    auto z() { return FieldView<float>(&begin_->z_); }
+    auto t() { return FieldView<float>(&begin_->t_); }
+
+private:
+    P* begin_;
+};
+
+template <class P>
+class BasicParticleSpan {
+public:
+    using pointer = P*;
+    using iterator = pointer;
+    template <class T>
+    using FieldView = ArrayView<T, P>;
+
+    BasicParticleSpan(pointer b, pointer e) : begin_(b), end_(e) {};
+
+    iterator begin() const { return begin_; }
+    iterator end() const { return end_; }
+
+    std::size_t size() const { return end_ - begin_; }
+
+    auto pid() { return FieldView<std::int32_t>(&begin_->pid_, size()); }
+    auto px() { return FieldView<float>(&begin_->px_, size()); }
+    auto py() { return FieldView<float>(&begin_->py_, size()); }
+    auto pz() { return FieldView<float>(&begin_->pz_, size()); }
+    auto e() { return FieldView<float>(&begin_->e_, size()); }
+    auto x() { return FieldView<float>(&begin_->x_, size()); }
+    auto y() { return FieldView<float>(&begin_->y_, size()); }
+    auto z() { return FieldView<float>(&begin_->z_, size()); }
+    auto t() { return FieldView<float>(&begin_->t_, size()); }
+
+    // the N particles starting at offset
+    template <int N>
+    FixedParticleSpan<P, N> fixed(std::size_t offset) {
+      assert(offset + N <= size());
+      return FixedParticleSpan<P, N>(begin_ + offset);
+    }
+
+private:
+    iterator begin_, end_;
+};
+
+// calls f on the span as blocks of N particles; the remainder is covered by at most
+// one block each of N/2, N/4, ..., 1 particles, so every block has a compile-time size
+template <int N, class P, class F>
+void for_each_fixed_block(BasicParticleSpan<P> span, F&& f) {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "block size must be a power of two");
+  std::size_t i = 0;
+  for (; i + N <= span.size(); i += N) {
+    auto block = span.template fixed<N>(i);
+    f(block);
+  }
+  if constexpr (N > 1)
+    for_each_fixed_block<N / 2>(BasicParticleSpan<P>(span.begin() + i, span.end()), f);
+}
+
+using ParticleSpan = BasicParticleSpan<Particle>;
+using PaddedParticleSpan = BasicParticleSpan<PaddedParticle>;
+
+// read-only view of particles; several observers may use it concurrently, as long as
+// no process writes to the particles at the same time
+template <class P>
+class BasicConstParticleSpan {
 public:
-    using pointer = Particle*;
+    using pointer = const P*;
     using iterator = pointer;
+    template <class T>
+    using FieldView = ArrayView<const T, P>;
+
+    BasicConstParticleSpan(pointer b, pointer e) : begin_(b), end_(e) {};
+    BasicConstParticleSpan(const BasicParticleSpan<P>& span)
+        : begin_(span.begin()), end_(span.end()) {};
+
+    iterator begin() const { return begin_; }
+    iterator end() const { return end_; }
+
+    std::size_t size() const { return end_ - begin_; }
+
+    auto pid() const { return FieldView<std::int32_t>(&begin_->pid_, size()); }
+    auto px() const { return FieldView<float>(&begin_->px_, size()); }
+    auto py() const { return FieldView<float>(&begin_->py_, size()); }
+    auto pz() const { return FieldView<float>(&begin_->pz_, size()); }
+    auto e() const { return FieldView<float>(&begin_->e_, size()); }
+    auto x() const { return FieldView<float>(&begin_->x_, size()); }
+    auto y() const { return FieldView<float>(&begin_->y_, size()); }
+    auto z() const { return FieldView<float>(&begin_->z_, size()); }
+    auto t() const { return FieldView<float>(&begin_->t_, size()); }
+
+private:
+    iterator begin_, end_;
+};
+
+using ConstParticleSpan = BasicConstParticleSpan<Particle>;
+
+// structure-of-arrays stack: each field lives in its own contiguous, aligned array
+class ParticleStackSoA {
+public:
+    template <class T>
+    using vector = std::vector<T, Eigen::aligned_allocator<T>>;
+
+    ParticleStackSoA() = default;
+
+    explicit ParticleStackSoA(std::vector<Particle>& aos) {
+      resize(aos.size());
+      for (std::size_t i = 0; i < aos.size(); ++i)
+        load(i, aos[i]);
+    }
+
+    std::size_t size() const { return pid_.size(); }
+
+    void resize(std::size_t n) {
+      pid_.resize(n);
+      px_.resize(n); py_.resize(n); pz_.resize(n); e_.resize(n);
+      x_.resize(n); y_.resize(n); z_.resize(n); t_.resize(n);
+    }
+
+    // copy particle p into slot i
+    void load(std::size_t i, Particle& p) {
+      pid_[i] = p.pid();
+      px_[i] = p.px(); py_[i] = p.py(); pz_[i] = p.pz(); e_[i] = p.e();
+      x_[i] = p.x(); y_[i] = p.y(); z_[i] = p.z(); t_[i] = p.t();
+    }
+
+    // copy slot i back into particle p
+    void store(std::size_t i, Particle& p) const {
+      p.pid() = pid_[i];
+      p.px() = px_[i]; p.py() = py_[i]; p.pz() = pz_[i]; p.e() = e_[i];
+      p.x() = x_[i]; p.y() = y_[i]; p.z() = z_[i]; p.t() = t_[i];
+    }
+
+    // copy the fields in `set` of particles first[index[k]] into slots k < n; a full
+    // set is copied particle by particle, otherwise field by field
+    void gather(Particle* first, const std::uint32_t* index, std::size_t n, FieldSet set) {
+      if (set == fields::all) {
+        for (std::size_t k = 0; k < n; ++k)
+          load(k, first[index[k]]);
+        return;
+      }
+      for_each_field(set, [&](auto* column, auto member) {
+        for (std::size_t k = 0; k < n; ++k)
+          column[k] = first[index[k]].*member;
+      });
+    }
+
+    // inverse of gather
+    void scatter(Particle* first, const std::uint32_t* index, std::size_t n, FieldSet set) {
+      if (set == fields::all) {
+        for (std::size_t k = 0; k < n; ++k)
+          store(k, first[index[k]]);
+        return;
+      }
+      for_each_field(set, [&](auto* column, auto member) {
+        for (std::size_t k = 0; k < n; ++k)
+          first[index[k]].*member = column[k];
+      });
+    }
+
+    template <class F>
+    void for_each_field(FieldSet set, F&& f) {
+      if (set & fields::pid) f(pid_.data(), &Particle::pid_);
+      if (set & fields::px) f(px_.data(), &Particle::px_);
+      if (set & fields::py) f(py_.data(), &Particle::py_);
+      if (set & fields::pz) f(pz_.data(), &Particle::pz_);
+      if (set & fields::e) f(e_.data(), &Particle::e_);
+      if (set & fields::x) f(x_.data(), &Particle::x_);
+      if (set & fields::y) f(y_.data(), &Particle::y_);
+      if (set & fields::z) f(z_.data(), &Particle::z_);
+      if (set & fields::t) f(t_.data(), &Particle::t_);
+    }
+
+    // "private" variables
+    vector<std::int32_t> pid_;
+    vector<float> px_, py_, pz_, e_;
+    vector<float> x_, y_, z_, t_;
+};
+
+// same interface as ParticleSpan, but the views are contiguous (no InnerStride);
+// the maps are unaligned, since a sub-span may start anywhere in the stack
+class ParticleSpanSoA {
+public:
+    using ArrayFView = Eigen::Map<Eigen::Array<float, Eigen::Dynamic, 1>>;
+    using ArrayIView = Eigen::Map<Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>;
+
+    ParticleSpanSoA(ParticleStackSoA& stack, std::size_t b, std::size_t e)
+        : stack_(&stack), begin_(b), end_(e) {};
+
+    std::size_t size() { return end_ - begin_; }
+
+    ArrayIView pid() { return ArrayIView(stack_->pid_.data() + begin_, size()); }
+    ArrayFView px() { return ArrayFView(stack_->px_.data() + begin_, size()); }
+    ArrayFView py() { return ArrayFView(stack_->py_.data() + begin_, size()); }
+    ArrayFView pz() { return ArrayFView(stack_->pz_.data() + begin_, size()); }
+    ArrayFView e() { return ArrayFView(stack_->e_.data() + begin_, size()); }
+    ArrayFView x() { return ArrayFView(stack_->x_.data() + begin_, size()); }
+    ArrayFView y() { return ArrayFView(stack_->y_.data() + begin_, size()); }
+    ArrayFView z() { return ArrayFView(stack_->z_.data() + begin_, size()); }
+    ArrayFView t() { return ArrayFView(stack_->t_.data() + begin_, size()); }
+
+private:
+    ParticleStackSoA* stack_;
+    std::size_t begin_, end_;
+};
+
+// hot/cold split: the fields which energy_loss needs and the position and time,
+// which only move_particle needs, are kept in two parallel arrays of structs
+struct HotParticle {
+  std::int32_t pid_;
+  float px_, py_, pz_, e_;
+};
+
+struct ColdParticle {
+  float x_, y_, z_, t_;
+};
+
+class ParticleStackHotCold {
+public:
+    explicit ParticleStackHotCold(std::vector<Particle>& aos) : hot_(aos.size()), cold_(aos.size()) {
+      for (std::size_t i = 0; i < aos.size(); ++i) {
+        auto& p = aos[i];
+        hot_[i] = {p.pid(), p.px(), p.py(), p.pz(), p.e()};
+        cold_[i] = {p.x(), p.y(), p.z(), p.t()};
+      }
+    }
+
+    std::size_t size() const { return hot_.size(); }
+
+    HotParticle* hot() { return hot_.data(); }
+    ColdParticle* cold() { return cold_.data(); }
+
+private:
+    std::vector<HotParticle> hot_;
+    std::vector<ColdParticle> cold_;
+};
+
+// same interface as ParticleSpan; a kernel only pulls the array it needs into cache
+class ParticleSpanHotCold {
+public:
+    using ArrayHotFView = ArrayView<float, HotParticle>;
+    using ArrayHotIView = ArrayView<std::int32_t, HotParticle>;
+    using ArrayColdFView = ArrayView<float, ColdParticle>;
+
+    ParticleSpanHotCold(ParticleStackHotCold& stack, std::size_t b, std::size_t e)
+        : hot_(stack.hot() + b), cold_(stack.cold() + b), size_(e - b) {};
+
+    std::size_t size() { return size_; }
+
+    ArrayHotIView pid() { return ArrayHotIView(&hot_->pid_, size_); }
+    ArrayHotFView px() { return ArrayHotFView(&hot_->px_, size_); }
+    ArrayHotFView py() { return ArrayHotFView(&hot_->py_, size_); }
+    ArrayHotFView pz() { return ArrayHotFView(&hot_->pz_, size_); }
+    ArrayHotFView e() { return ArrayHotFView(&hot_->e_, size_); }
+    ArrayColdFView x() { return ArrayColdFView(&cold_->x_, size_); }
+    ArrayColdFView y() { return ArrayColdFView(&cold_->y_, size_); }
+    ArrayColdFView z() { return ArrayColdFView(&cold_->z_, size_); }
+    ArrayColdFView t() { return ArrayColdFView(&cold_->t_, size_); }
+
+private:
+    HotParticle* hot_;
+    ColdParticle* cold_;
+    std::size_t size_;
+};
+
+// subset of a ParticleSpan, given by a selection vector of indices; the Eigen
+// kernels are applied by gathering the selected particles into a contiguous
+// scratch stack, computing there, and scattering the result back
+class FilteredSpan {
+public:
+    // mask is a boolean Eigen expression over the span, e.g. span.e() > cut
+    template <class Mask>
+    void select(ParticleSpan span, const Mask& mask) {
+      span_ = span;
+      // one pass over the span into a byte mask; the ParticleSpan maps are strided,
+      // so Eigen evaluates the predicate element by element, not with SIMD
+      mask_ = mask;
+      index_.resize(span.size());
+      // branch-free compaction of the mask into indices
+      std::size_t n = 0;
+      for (std::size_t i = 0; i < span.size(); ++i) {
+        index_[n] = i;
+        n += mask_[i];
+      }
+      index_.resize(n);
+    }
+
+    std::size_t size() const { return index_.size(); }
+
+    // f is called with a ParticleSpanSoA over the selected particles; only the fields
+    // which f reads are gathered and only those which it writes are scattered back
+    template <class F>
+    void apply(F&& f, FieldSet reads = fields::all, FieldSet writes = fields::all) {
+      scratch_.resize(size());
+      scratch_.gather(span_.begin(), index_.data(), size(), reads | writes);
+      ParticleSpanSoA soa(scratch_, 0, size());
+      f(soa);
+      scratch_.scatter(span_.begin(), index_.data(), size(), writes);
+    }
+
+private:
+    ParticleSpan span_{nullptr, nullptr};
+    Eigen::Array<bool, Eigen::Dynamic, 1> mask_;
+    std::vector<std::uint32_t> index_;
+    ParticleStackSoA scratch_;
+};
+
+// persistent pool of worker threads; the calling thread takes part in the work
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned n_threads) {
+      for (unsigned k = 1; k < n_threads; ++k)
+        threads_.emplace_back([this, k] { work(k); });
+    }
+
+    ~ThreadPool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      start_.notify_all();
+      for (auto&& t : threads_)
+        t.join();
+    }
+
+    unsigned size() const { return threads_.size() + 1; }
+
+    // calls f(i) for all i in [0, n), each index is claimed by the next free thread;
+    // returns when all calls are done
+    template <class F>
+    void parallel_for(std::size_t n, F&& f) {
+      dispatch(std::ref(f), n, false);
+    }
+
+    // calls f(k) exactly once on each thread, where k in [0, size()) is the index of
+    // the thread and 0 is the calling thread; returns when all calls are done
+    template <class F>
+    void for_each_thread(F&& f) {
+      dispatch(std::ref(f), size(), true);
+    }
+
+private:
+    void dispatch(std::function<void(std::size_t)> task, std::size_t n, bool per_thread) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = std::move(task);
+        n_tasks_ = n;
+        per_thread_ = per_thread;
+        next_ = 0;
+        busy_ = threads_.size();
+        ++generation_;
+      }
+      start_.notify_all();
+      run_tasks(0);
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait(lock, [this] { return busy_ == 0; });
+    }
+
+    void run_tasks(unsigned index) {
+      if (per_thread_) {
+        task_(index);
+        return;
+      }
+      for (std::size_t i; (i = next_.fetch_add(1, std::memory_order_relaxed)) < n_tasks_;)
+        task_(i);
+    }
+
+    void work(unsigned index) {
+      std::uint64_t seen = 0;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+          if (stop_)
+            return;
+          seen = generation_;
+        }
+        run_tasks(index);
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          --busy_;
+        }
+        done_.notify_one();
+      }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    std::function<void(std::size_t)> task_;
+    std::size_t n_tasks_ = 0;
+    bool per_thread_ = false;
+    std::atomic<std::size_t> next_{0};
+    std::size_t busy_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+// removes dead particles from a span, moving the survivors to its front; the kill
+// predicate is a boolean Eigen expression over the span, e.g. !(span.e() >= cut),
+// which is also true for NaN energies
+class Compactor {
+public:
+    // returns the number of survivors; keeping the order costs one copy per particle,
+    // otherwise holes are filled from the back with one copy per killed particle
+    template <class Mask>
+    std::size_t operator()(ParticleSpan span, const Mask& kill, bool keep_order = true) {
+      // one pass over the span into a byte mask; scalar, like in FilteredSpan::select
+      kill_ = kill;
+      auto p = span.begin();
+      std::size_t n = span.size();
+      if (keep_order) {
+        std::size_t m = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+          p[m] = p[i];
+          m += !kill_[i];
+        }
+        return m;
+      }
+      for (std::size_t i = 0; i < n;) {
+        if (kill_[i]) {
+          --n;
+          p[i] = p[n];
+          kill_[i] = kill_[n];
+        } else {
+          ++i;
+        }
+      }
+      return n;
+    }
+
+    // order-preserving version which writes the survivors to out, using one chunk per
+    // thread of the pool: each counts the survivors in its chunk, an exclusive prefix
+    // sum over the counts gives the offsets at which the threads write their survivors
+    template <class Mask>
+    std::size_t parallel(ThreadPool& pool, ParticleSpan span, const Mask& kill,
+                         std::vector<Particle>& out) {
+      const std::size_t n = span.size();
+      const std::size_t n_chunks = pool.size();
+      kill_.resize(n);
+      offset_.assign(n_chunks + 1, 0);
+      auto chunk = [&](std::size_t k) {
+        return std::make_pair(n * k / n_chunks, n * (k + 1) / n_chunks);
+      };
+      pool.parallel_for(n_chunks, [&](std::size_t k) {
+        const auto [b, e] = chunk(k);
+        kill_.segment(b, e - b) = kill.segment(b, e - b);
+        offset_[k + 1] = (e - b) - kill_.segment(b, e - b).count();
+      });
+      std::partial_sum(offset_.begin(), offset_.end(), offset_.begin());
+      out.resize(offset_.back());
+      pool.parallel_for(n_chunks, [&](std::size_t k) {
+        const auto [b, e] = chunk(k);
+        auto p = span.begin();
+        auto o = out.data() + offset_[k];
+        for (std::size_t i = b; i < e; ++i)
+          if (!kill_[i])
+            *o++ = p[i];
+      });
+      return out.size();
+    }
+
+private:
+    Eigen::Array<bool, Eigen::Dynamic, 1> kill_;
+    std::vector<std::size_t> offset_;
+};
+
+// append-only output buffer for the secondaries which a process creates in one
+// step; it is a slice of a SecondaryArena with a fixed capacity, so it never
+// reallocates and spans into the stack stay valid while processes run
+class SecondaryBuffer {
+public:
+    SecondaryBuffer(Particle* b, std::size_t capacity) : begin_(b), size_(0), capacity_(capacity) {}
+
+    // throws if a process emits more than its max_secondaries()
+    void push_back(const Particle& p) {
+      if (size_ == capacity_)
+        throw std::length_error("SecondaryBuffer: capacity exceeded");
+      begin_[size_++] = p;
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return capacity_; }
+
+    ParticleSpan span() { return {begin_, begin_ + size_}; }
+
+private:
+    Particle* begin_;
+    std::size_t size_, capacity_;
+};
+
+// storage for the secondary buffers of one step; memory is only allocated in
+// reset(), before the processes run, and reused across steps
+class SecondaryArena {
+public:
+    // discards all buffers and makes room for `capacity` secondaries in total
+    void reset(std::size_t capacity) {
+      if (storage_.size() < capacity)
+        storage_.resize(capacity);
+      reset(storage_.data(), capacity);
+    }
+
+    // same, with storage owned by the caller, e.g. the tail of the stack
+    void reset(Particle* storage, std::size_t capacity) {
+      base_ = storage;
+      capacity_ = capacity;
+      buffers_.clear();
+      used_ = 0;
+    }
+
+    // throws if the buffers would not fit into the storage from reset()
+    SecondaryBuffer& allocate(std::size_t capacity) {
+      if (used_ + capacity > capacity_)
+        throw std::length_error("SecondaryArena: capacity exceeded");
+      buffers_.emplace_back(base_ + used_, capacity);
+      used_ += capacity;
+      return buffers_.back();
+    }
+
+    std::size_t size() const {
+      std::size_t n = 0;
+      for (auto&& b : buffers_)
+        n += b.size();
+      return n;
+    }
+
+    // calls f(span) for the secondaries in each buffer
+    template <class F>
+    void for_each_span(F&& f) {
+      for (auto&& b : buffers_)
+        f(b.span());
+    }
+
+    // appends the content of all buffers to the stack
+    void merge_into(std::vector<Particle>& stack) {
+      stack.reserve(stack.size() + size());
+      for (auto&& b : buffers_) {
+        auto span = b.span();
+        stack.insert(stack.end(), span.begin(), span.end());
+      }
+      buffers_.clear();
+      used_ = 0;
+    }
+
+    // moves the content of all buffers to the front of the storage, so that the
+    // secondaries are contiguous, and returns their number
+    std::size_t pack() {
+      Particle* out = base_;
+      for (auto&& b : buffers_) {
+        auto span = b.span();
+        std::memmove(out, span.begin(), span.size() * sizeof(Particle));
+        out += span.size();
+      }
+      buffers_.clear();
+      used_ = 0;
+      return out - base_;
+    }
+
+private:
+    std::vector<Particle> storage_;
+    Particle* base_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::deque<SecondaryBuffer> buffers_; // deque keeps references stable
+    std::size_t used_ = 0;
+};
+
+// array-of-structs-of-arrays: a tile holds W particles, each field is a contiguous
+// block of W values, so a field over several tiles is a W x n_tiles Eigen array
+template <int W>
+struct alignas(W * sizeof(float)) ParticleTile {
+  std::int32_t pid_[W];
+  float px_[W], py_[W], pz_[W], e_[W];
+  float x_[W], y_[W], z_[W], t_[W];
+};
+
+template <int W>
+class ParticleStackAoSoA {
+public:
+    static_assert(W >= 4 && (W & (W - 1)) == 0, "tile width must be a power of two >= 4");
+    static_assert(sizeof(ParticleTile<W>) == 9 * W * sizeof(float));
+
+    explicit ParticleStackAoSoA(std::vector<Particle>& aos)
+        : tiles_((aos.size() + W - 1) / W), size_(aos.size()) {
+      for (std::size_t i = 0; i < aos.size(); ++i) {
+        auto& p = aos[i];
+        auto& tile = tiles_[i / W];
+        const auto k = i % W;
+        tile.pid_[k] = p.pid();
+        tile.px_[k] = p.px(); tile.py_[k] = p.py(); tile.pz_[k] = p.pz(); tile.e_[k] = p.e();
+        tile.x_[k] = p.x(); tile.y_[k] = p.y(); tile.z_[k] = p.z(); tile.t_[k] = p.t();
+      }
+    }
+
+    std::size_t size() const { return size_; }
+
+    ParticleTile<W>* tiles() { return tiles_.data(); }
+
+private:
+    std::vector<ParticleTile<W>> tiles_;
+    std::size_t size_;
+};
+
+// view over the first Rows particles of consecutive tiles; Rows is W for full tiles
+// and Eigen::Dynamic for the partially filled last tile of a span
+template <int W, int Rows>
+class ParticleTileView {
+public:
+    template <class T>
+    using ArrayView = Eigen::Map<
+        Eigen::Array<T, Rows, Eigen::Dynamic>,
+        W * sizeof(float), // matches Eigen::AlignedN, see alignas of ParticleTile
+        Eigen::OuterStride<9 * W>
+    >;
     using ArrayFView = ArrayView<float>;
     using ArrayIView = ArrayView<std::int32_t>;
 
-    ParticleSpan(pointer b, pointer e) : begin_(b), end_(e) {};
+    ParticleTileView(ParticleTile<W>* first, Eigen::Index rows, Eigen::Index cols)
+        : first_(first), rows_(rows), cols_(cols) {};
 
-    iterator begin() { return begin_; }
-    iterator end() { return end_; }
+    std::size_t size() { return rows_ * cols_; }
 
-    std::size_t size() { return end_ - begin_; }
+    ArrayIView pid() { return ArrayIView(first_->pid_, rows_, cols_); }
+    ArrayFView px() { return ArrayFView(first_->px_, rows_, cols_); }
+    ArrayFView py() { return ArrayFView(first_->py_, rows_, cols_); }
+    ArrayFView pz() { return ArrayFView(first_->pz_, rows_, cols_); }
+    ArrayFView e() { return ArrayFView(first_->e_, rows_, cols_); }
+    ArrayFView x() { return ArrayFView(first_->x_, rows_, cols_); }
+    ArrayFView y() { return ArrayFView(first_->y_, rows_, cols_); }
+    ArrayFView z() { return ArrayFView(first_->z_, rows_, cols_); }
+    ArrayFView t() { return ArrayFView(first_->t_, rows_, cols_); }
+
+private:
+    ParticleTile<W>* first_;
+    Eigen::Index rows_, cols_;
+};
+
+// tile-aware span, must start at a tile boundary; kernels run once over the full
+// tiles and once over the remainder in the last tile
+template <int W>
+class ParticleSpanAoSoA {
+public:
+    ParticleSpanAoSoA(ParticleStackAoSoA<W>& stack, std::size_t b, std::size_t e)
+        : first_(stack.tiles() + b / W), size_(e - b) {
+      assert(b % W == 0);
+    };
 
-    ArrayIView pid() { return ArrayIView(&begin_->pid_, size()); }
-    ArrayFView px() { return ArrayFView(&begin_->px_, size()); }
-    ArrayFView py() { return ArrayFView(&begin_->py_, size()); }
-    ArrayFView pz() { return ArrayFView(&begin_->pz_, size()); }
-    ArrayFView e() { return ArrayFView(&begin_->e_, size()); }
-    ArrayFView x() { return ArrayFView(&begin_->x_, size()); }
-    ArrayFView y() { return ArrayFView(&begin_->y_, size()); }
-    ArrayFView z() { return ArrayFView(&begin_->z_, size()); }
-    ArrayFView t() { return ArrayFView(&begin_->t_, size()); }
+    std::size_t size() { return size_; }
+
+    ParticleTileView<W, W> tiles() { return {first_, W, Eigen::Index(size_ / W)}; }
+    ParticleTileView<W, Eigen::Dynamic> tail() {
+      return {first_ + size_ / W, Eigen::Index(size_ % W), 1};
+    }
+
+    template <class F>
+    void for_each_view(F&& f) {
+      if (size_ >= W) {
+        auto v = tiles();
+        f(v);
+      }
+      if (size_ % W) {
+        auto v = tail();
+        f(v);
+      }
+    }
 
 private:
-    iterator begin_, end_;
+    ParticleTile<W>* first_;
+    std::size_t size_;
+};
+
+// compile-time particle database; Particle::pid() is the dense index into this table,
+// not the PDG id, so that property lookups are a gather from a small array
+struct ParticleData {
+  std::int32_t pdg;
+  float charge;   // in units of the elementary charge
+  float mass;     // in GeV
+  float lifetime; // in s
+};
+
+constexpr float stable = std::numeric_limits<float>::infinity();
+
+constexpr ParticleData particle_data[] = {
+  {22, 0, 0, stable},                // gamma
+  {11, -1, 0.000511f, stable},       // e-
+  {-11, 1, 0.000511f, stable},       // e+
+  {13, -1, 0.105658f, 2.197e-6f},    // mu-
+  {-13, 1, 0.105658f, 2.197e-6f},    // mu+
+  {111, 0, 0.134977f, 8.52e-17f},    // pi0
+  {211, 1, 0.139570f, 2.603e-8f},    // pi+
+  {-211, -1, 0.139570f, 2.603e-8f},  // pi-
+  {130, 0, 0.497611f, 5.116e-8f},    // K0L
+  {321, 1, 0.493677f, 1.238e-8f},    // K+
+  {-321, -1, 0.493677f, 1.238e-8f},  // K-
+  {2212, 1, 0.938272f, stable},      // p
+  {-2212, -1, 0.938272f, stable},    // anti-p
+  {2112, 0, 0.939565f, 879.4f},      // n
+  {-2112, 0, 0.939565f, 879.4f},     // anti-n
 };
 
+constexpr std::size_t n_particle_types = std::size(particle_data);
+
+// returns -1 for PDG ids which are not in the database
+constexpr std::int32_t pid_from_pdg(std::int32_t pdg) {
+  for (std::size_t i = 0; i < n_particle_types; ++i)
+    if (particle_data[i].pdg == pdg)
+      return i;
+  return -1;
+}
+
+// one contiguous table per property, each only a few cache lines long
+template <class T>
+constexpr auto make_property_table(T ParticleData::*member) {
+  std::array<T, n_particle_types> table{};
+  for (std::size_t i = 0; i < n_particle_types; ++i)
+    table[i] = particle_data[i].*member;
+  return table;
+}
+
+constexpr auto charge_table = make_property_table(&ParticleData::charge);
+constexpr auto mass_table = make_property_table(&ParticleData::mass);
+constexpr auto lifetime_table = make_property_table(&ParticleData::lifetime);
+
 // setup the particle stack for the benchmarks
-auto setup_stack() {
-  std::vector<Particle> stack(100000);
+// std::vector uses aligned new for over-aligned types like PaddedParticle
+template <class P = Particle>
+auto setup_stack(std::size_t n = 100000) {
+  std::vector<P> stack(n);
+  constexpr std::int32_t pions[] = {pid_from_pdg(-211), pid_from_pdg(111), pid_from_pdg(211)};
   int i = 0;
   // make 1/3 of particles neutral
   for (auto&& part : stack)
-    part.pid() = (++i % 3 - 1);
+    part.pid() = pions[++i % 3];
+  return stack;
+}
+
+// mix of particle types roughly as in an air shower at ground level
+template <class P = Particle>
+auto setup_realistic_stack() {
+  std::vector<P> stack(100000);
+  constexpr std::int32_t pdgs[] = {22, 11, -11, 13, -13, 211, -211, 2212, 2112};
+  std::discrete_distribution<int> dist({80, 8, 6, 2, 2, 0.7, 0.7, 0.3, 0.3});
+  std::mt19937 rng(1);
+  for (auto&& part : stack)
+    part.pid() = pid_from_pdg(pdgs[dist(rng)]);
   return stack;
 }
 
@@ -87,100 +909,1536 @@ decltype(auto) momentum_squared(T& part) {
   return sqr(part.px()) + sqr(part.py()) + sqr(part.pz());
 }
 
+// lookup in the charge table; for spans this is an Eigen expression over a gather
 template <class T>
 decltype(auto) charge(T& part) {
-  // this could be a complicated function or a lookup table
-  return part.pid() != 0;
+  if constexpr (std::is_arithmetic<std::decay_t<decltype(part.pid())>>::value)
+    return charge_table[part.pid()];
+  else
+    return part.pid().unaryExpr([](std::int32_t pid) { return charge_table[pid]; });
+}
+
+// stack which keeps charged particles in front of neutral ones, so that processes
+// which only act on charged particles get a contiguous sub-span; the order of
+// particles is not preserved, adding or changing a particle moves at most one other
+class ChargePartitionedStack {
+public:
+    explicit ChargePartitionedStack(std::vector<Particle> particles)
+        : particles_(std::move(particles)) {
+      auto it = std::partition(particles_.begin(), particles_.end(),
+                               [](Particle& p) { return charge(p) != 0; });
+      n_charged_ = it - particles_.begin();
+    }
+
+    std::size_t size() const { return particles_.size(); }
+    std::size_t n_charged() const { return n_charged_; }
+
+    void push_back(const Particle& p) {
+      particles_.push_back(p);
+      if (charge(particles_.back()) != 0)
+        std::swap(particles_[n_charged_++], particles_.back());
+    }
+
+    // may move the particle at index i, and one other particle, to restore the partition
+    void set_pid(std::size_t i, std::int32_t pid) {
+      const bool was_charged = i < n_charged_;
+      particles_[i].pid() = pid;
+      const bool is_charged = charge(particles_[i]) != 0;
+      if (was_charged && !is_charged)
+        std::swap(particles_[i], particles_[--n_charged_]);
+      else if (!was_charged && is_charged)
+        std::swap(particles_[i], particles_[n_charged_++]);
+    }
+
+    Particle& operator[](std::size_t i) { return particles_[i]; }
+
+    ParticleSpan all() { return {particles_.data(), particles_.data() + size()}; }
+    ParticleSpan charged() { return {particles_.data(), particles_.data() + n_charged_}; }
+    ParticleSpan neutral() { return {particles_.data() + n_charged_, particles_.data() + size()}; }
+
+private:
+    std::vector<Particle> particles_;
+    std::size_t n_charged_;
+};
+
+// x = m 2^e with m in [0.5, 1), like std::frexp, but without handling of zero,
+// denormals, inf and NaN
+inline float fast_frexp(float x, float& e) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(float));
+  e = float(int((bits >> 23) & 0xff) - 126);
+  bits = (bits & 0x807fffffu) | 0x3f000000u;
+  std::memcpy(&x, &bits, sizeof(float));
+  return x;
+}
+
+template <class Packet>
+Packet fast_frexp(const Packet& x, Packet& e) {
+  return Eigen::internal::pfrexp(x, e);
+}
+
+// minimax coefficients c[k] of log(1 + u) = sum c[k] u^(k+1) for a polynomial of the
+// given degree over u in [sqrt(1/2) - 1, sqrt(2) - 1), fitted with the Remez algorithm
+template <int Degree>
+struct fast_log_coefficients;
+
+// absolute error of the fit 2.0e-5
+template <>
+struct fast_log_coefficients<5> {
+  static constexpr float c[] = {9.997009757e-01f, -4.998696659e-01f, 3.442346177e-01f,
+                                -2.641956611e-01f, 1.264089762e-01f};
+};
+
+// absolute error of the fit 3.0e-7
+template <>
+struct fast_log_coefficients<7> {
+  static constexpr float c[] = {1.000006520e+00f, -5.000024484e-01f, 3.328363910e-01f,
+                                -2.494426245e-01f, 2.093820214e-01f, -1.840944436e-01f,
+                                1.001740590e-01f};
+};
+
+// absolute error of the fit 5.2e-9, below float precision
+template <>
+struct fast_log_coefficients<9> {
+  static constexpr float c[] = {9.999998528e-01f, -4.999999535e-01f, 3.333527062e-01f,
+                                -2.500182806e-01f, 1.993116473e-01f, -1.655954143e-01f,
+                                1.516207489e-01f, -1.443068075e-01f, 8.264174296e-02f};
+};
+
+// log(x) for positive normal x as e log(2) + log(1 + u) with u = m - 1, where the
+// second term is a polynomial of the given degree in u; like Eigen's plog, there is
+// no division, and u is exact
+template <int Degree, class Packet>
+Packet fast_log_impl(const Packet& x) {
+  namespace ei = Eigen::internal;
+  constexpr auto& c = fast_log_coefficients<Degree>::c;
+  Packet e;
+  Packet m = fast_frexp(x, e);
+  // move mantissa to [sqrt(1/2), sqrt(2)) to make |u| small
+  const Packet small = ei::pcmp_lt(m, ei::pset1<Packet>(0.70710678f));
+  m = ei::pselect(small, ei::padd(m, m), m);
+  e = ei::pselect(small, ei::psub(e, ei::pset1<Packet>(1.f)), e);
+  const Packet u = ei::psub(m, ei::pset1<Packet>(1.f));
+  Packet p = ei::pset1<Packet>(c[Degree - 1]);
+  for (int k = Degree - 2; k >= 0; --k)
+    p = ei::pmadd(p, u, ei::pset1<Packet>(c[k]));
+  return ei::pmadd(p, u, ei::pmul(e, ei::pset1<Packet>(0.69314718f)));
+}
+
+// Eigen functor, so that Eigen can call the packet version on contiguous maps
+template <int Degree>
+struct scalar_fast_log_op {
+  float operator()(const float& x) const { return fast_log_impl<Degree>(x); }
+  template <class Packet>
+  Packet packetOp(const Packet& x) const { return fast_log_impl<Degree>(x); }
+};
+
+namespace Eigen {
+namespace internal {
+template <int Degree>
+struct functor_traits<scalar_fast_log_op<Degree>> {
+  enum {
+    Cost = (Degree + 8) * NumTraits<float>::MulCost,
+    PacketAccess = packet_traits<float>::Vectorizable
+  };
+};
+} // namespace internal
+} // namespace Eigen
+
+// log functors for energy_loss, which work for scalars and Eigen expressions
+struct StdLog {
+  template <class T>
+  decltype(auto) operator()(const T& x) const {
+    using std::log; // allow Eigen to find its own log via ADL
+    return log(x);
+  }
+};
+
+template <int Degree>
+struct FastLog {
+  template <class T>
+  decltype(auto) operator()(const T& x) const {
+    if constexpr (std::is_arithmetic<T>::value)
+      return fast_log_impl<Degree>(static_cast<float>(x));
+    else
+      return x.unaryExpr(scalar_fast_log_op<Degree>());
+  }
+};
+
+// accuracy of the log in energy_loss, a template parameter of the process, so that
+// the log is chosen at compile time
+enum class LogAccuracy {
+  low,    // absolute error about 2e-5, FastLog<5>
+  medium, // absolute error about 6e-7, FastLog<7>
+  full    // std::log or Eigen's log
+};
+
+// note: this function body looks the same whether we pass one particle or a span!
+template <class T, class Log = StdLog>
+void energy_loss(T& part, Log log = {}) {
+  decltype(auto) beta_2 = momentum_squared(part) / sqr(part.e());
+  // compute energy loss, ignoring all constants
+  decltype(auto) energy_loss = sqr(charge(part)) * (log(beta_2 / (1.0 - beta_2)) / beta_2 - 1.0);
+  part.e() -= energy_loss;
+}
+
+// ... nevertheless we try a special one particle version for comparison
+template <class Log = StdLog>
+void energy_loss(Particle& part, Log log = {}) {
+  auto beta_2 = momentum_squared(part) / sqr(part.e());
+  const auto c = charge(part);
+  if (c != 0) {
+    // compute energy loss, ignoring all constants
+    const auto energy_loss = sqr(c) * (log(beta_2 / (1.0 - beta_2)) / beta_2 - 1.0);
+    part.e() -= energy_loss;    
+  }
+}
+
+// note: again function body looks the same whether we pass one particle or a span
+template <class T>
+void move_particle(T& p) {
+  const auto dt = 0.1;
+  p.x() += p.px() * dt;
+  p.y() += p.py() * dt;
+  p.z() += p.pz() * dt;
+  p.t() += dt;
+}
+
+// tiled spans are processed view by view with the generic kernels above
+template <int W, class Log = StdLog>
+void energy_loss(ParticleSpanAoSoA<W>& span, Log log = {}) {
+  span.for_each_view([log](auto& v) { energy_loss(v, log); });
+}
+
+template <int W>
+void move_particle(ParticleSpanAoSoA<W>& span) {
+  span.for_each_view([](auto& v) { move_particle(v); });
+}
+
+// explicit SIMD kernels for contiguous spans, independent of Eigen; N is the number
+// of floats per pack, 4/8/16 correspond to SSE/AVX2/AVX-512 register widths
+template <class T, int N>
+using simd = stdx::fixed_size_simd<T, N>;
+
+// a short tail is copied into a zero-padded pack, so the kernels see only full packs
+template <int N, class T>
+simd<T, N> simd_load(const T* p, std::size_t m) {
+  simd<T, N> v;
+  if (m == N)
+    v.copy_from(p, stdx::element_aligned);
+  else {
+    v = 0;
+    for (std::size_t k = 0; k < m; ++k)
+      v[k] = p[k];
+  }
+  return v;
+}
+
+template <int N, class T>
+void simd_store(const simd<T, N>& v, T* p, std::size_t m) {
+  if (m == N)
+    v.copy_to(p, stdx::element_aligned);
+  else
+    for (std::size_t k = 0; k < m; ++k)
+      p[k] = v[k];
+}
+
+template <int N>
+void energy_loss_simd(ParticleSpanSoA& span) {
+  const std::size_t n = span.size();
+  const std::int32_t* pid = span.pid().data();
+  const float* px = span.px().data();
+  const float* py = span.py().data();
+  const float* pz = span.pz().data();
+  float* e = span.e().data();
+  for (std::size_t i = 0; i < n; i += N) {
+    const auto m = std::min<std::size_t>(N, n - i);
+    const auto pids = simd_load<N>(pid + i, m);
+    const simd<float, N> q([&pids](auto k) { return charge_table[pids[k]]; });
+    const auto beta_2 = (sqr(simd_load<N>(px + i, m)) + sqr(simd_load<N>(py + i, m)) +
+                         sqr(simd_load<N>(pz + i, m))) / sqr(simd_load<N>(e + i, m));
+    // compute energy loss, ignoring all constants
+    simd<float, N> energy_loss = 0;
+    where(q != 0, energy_loss) = sqr(q) * (log(beta_2 / (1.0f - beta_2)) / beta_2 - 1.0f);
+    simd_store(simd_load<N>(e + i, m) - energy_loss, e + i, m);
+  }
+}
+
+template <int N>
+void move_particle_simd(ParticleSpanSoA& span) {
+  const float dt = 0.1;
+  const std::size_t n = span.size();
+  const float* pv[3] = {span.px().data(), span.py().data(), span.pz().data()};
+  float* xv[3] = {span.x().data(), span.y().data(), span.z().data()};
+  float* t = span.t().data();
+  for (std::size_t i = 0; i < n; i += N) {
+    const auto m = std::min<std::size_t>(N, n - i);
+    for (int k = 0; k < 3; ++k)
+      simd_store(simd_load<N>(xv[k] + i, m) + simd_load<N>(pv[k] + i, m) * dt, xv[k] + i, m);
+    simd_store(simd_load<N>(t + i, m) + dt, t + i, m);
+  }
+}
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11): the random numbers
+// of a particle depend only on the key (shower id) and the counter (particle id, step);
+// Particle has no identity of its own, so the ids come from the caller, and the
+// numbers do not change with threads or chunking only as long as the ids are stable
+class Philox {
+public:
+    explicit Philox(std::uint64_t shower_id) : k0_(shower_id & 0xffffffff), k1_(shower_id >> 32) {}
+
+    // ten rounds on a counter of four 32 bit words; V is std::uint64_t or a simd pack
+    // of it, the upper halves stay zero, so one multiplication gives hi and lo words
+    template <class V>
+    void operator()(std::array<V, 4>& c) const {
+      std::uint64_t k0 = k0_, k1 = k1_;
+      for (int r = 0; r < 10; ++r) {
+        const V p0 = c[0] * V(0xD2511F53), p1 = c[2] * V(0xCD9E8D57);
+        c = {(p1 >> 32) ^ c[1] ^ k0, p1 & 0xffffffff, (p0 >> 32) ^ c[3] ^ k1, p0 & 0xffffffff};
+        k0 = (k0 + 0x9E3779B9) & 0xffffffff;
+        k1 = (k1 + 0xBB67AE85) & 0xffffffff;
+      }
+    }
+
+    // four uniforms in [0, 1) per particle of the span, one row each, where the i-th
+    // particle has the id ids[i]; N is the number of 64 bit lanes per pack, 8 fill one
+    // AVX-512 register and were fastest here
+    template <int N = 8, class Span>
+    void uniform(const Span& span, const Eigen::Array<std::uint64_t, Eigen::Dynamic, 1>& ids,
+                 std::uint32_t step, Eigen::Array<float, Eigen::Dynamic, 4>& u) const {
+      assert(std::size_t(ids.size()) == span.size());
+      fill<N>(span.size(), step, u, [&ids](std::size_t i) { return ids[i]; });
+    }
+
+    // same, where the i-th particle has the id first_particle + i; only reproducible
+    // if the span is not reordered between steps, which compaction does
+    template <int N = 8, class Span>
+    void uniform(const Span& span, std::uint64_t first_particle, std::uint32_t step,
+                 Eigen::Array<float, Eigen::Dynamic, 4>& u) const {
+      fill<N>(span.size(), step, u, [first_particle](std::size_t i) { return first_particle + i; });
+    }
+
+private:
+    template <int N, class Id>
+    void fill(std::size_t n, std::uint32_t step, Eigen::Array<float, Eigen::Dynamic, 4>& u,
+              Id id_of) const {
+      using V = simd<std::uint64_t, N>;
+      u.resize(n, 4);
+      for (std::size_t i = 0; i < n; i += N) {
+        const auto m = std::min<std::size_t>(N, n - i);
+        const V id([&](auto k) { return i + k < n ? id_of(i + k) : 0; });
+        std::array<V, 4> c = {id & 0xffffffff, id >> 32, V(step), V(0)};
+        (*this)(c);
+        for (int w = 0; w < 4; ++w)
+          simd_store(stdx::static_simd_cast<simd<float, N>>(c[w] >> 8) * 0x1p-24f,
+                     u.col(w).data() + i, m);
+      }
+    }
+
+    std::uint64_t k0_, k1_;
+};
+
+template <LogAccuracy A = LogAccuracy::full>
+struct BasicContinuousEnergyLoss {
+  static constexpr bool charged_only = true;
+  static constexpr FieldSet reads = fields::pid | fields::momentum | fields::e;
+  static constexpr FieldSet writes = fields::e;
+
+  using Log = std::conditional_t<A == LogAccuracy::low, FastLog<5>,
+              std::conditional_t<A == LogAccuracy::medium, FastLog<7>, StdLog>>;
+
+  template <class T>
+  void operator()(T& p) const {
+    energy_loss(p, Log());
+  }
+};
+
+using ContinuousEnergyLoss = BasicContinuousEnergyLoss<>;
+
+struct ContinuousEnergyLossNoEigen {
+  static constexpr bool charged_only = true;
+  static constexpr FieldSet reads = fields::pid | fields::momentum | fields::e;
+  static constexpr FieldSet writes = fields::e;
+
+  void operator()(ParticleSpan& span) const {
+    for (auto&& p : span)
+      energy_loss(p);
+  }
+};
+
+struct MoveParticle {
+  static constexpr FieldSet reads = fields::momentum | fields::position | fields::t;
+  static constexpr FieldSet writes = fields::position | fields::t;
+
+  template <class T>
+  void operator()(T& p) const { move_particle(p); }
+};
+
+struct MoveParticleNoEigen {
+  static constexpr FieldSet reads = fields::momentum | fields::position | fields::t;
+  static constexpr FieldSet writes = fields::position | fields::t;
+
+  void operator()(ParticleSpan& span) const {
+    for (auto&& p : span)
+      move_particle(p);
+  }
+};
+
+// processes which only act on charged particles declare `charged_only = true`
+template <class Process, class = void>
+struct is_charged_only : std::false_type {};
+
+template <class Process>
+struct is_charged_only<Process, std::void_t<decltype(Process::charged_only)>>
+    : std::bool_constant<Process::charged_only> {};
+
+// fields which a process reads and writes; processes without a declaration are
+// assumed to read and write everything
+template <class Process, class = void>
+constexpr FieldSet field_reads = fields::all;
+
+template <class Process>
+constexpr FieldSet field_reads<Process, std::void_t<decltype(Process::reads)>> = Process::reads;
+
+template <class Process, class = void>
+constexpr FieldSet field_writes = fields::all;
+
+template <class Process>
+constexpr FieldSet field_writes<Process, std::void_t<decltype(Process::writes)>> = Process::writes;
+
+// smallest span size from which on the span version of a process is faster than
+// calling it particle by particle, up to max_size, measured with a short
+// micro-benchmark; returns the largest std::size_t if the span version loses at max_size
+template <class Process>
+std::size_t calibrate_span_threshold(const Process& process, std::size_t max_size = 4096) {
+  using clock = std::chrono::steady_clock;
+  // each timed run updates every particle once, in consecutive spans of n particles,
+  // and the particles are restored between runs, so processes which change the energy
+  // do not run away to inf and NaN
+  auto initial = setup_stack(std::max<std::size_t>(max_size, 8192));
+  for (auto&& p : initial) {
+    p.px() = 0.3f;
+    p.py() = 0.4f;
+    p.pz() = 0.5f;
+    p.e() = 1.0f;
+  }
+  auto stack = initial;
+  // best of three runs
+  auto measure = [&](std::size_t n, auto&& f) {
+    auto best = clock::duration::max();
+    for (int run = 0; run < 3; ++run) {
+      stack = initial;
+      const auto t0 = clock::now();
+      for (std::size_t i = 0; i + n <= stack.size(); i += n) {
+        ParticleSpan span(stack.data() + i, stack.data() + i + n);
+        f(span);
+      }
+      best = std::min(best, clock::now() - t0);
+    }
+    return best;
+  };
+  // a single win is not enough, the span version must win at all larger sizes too
+  std::size_t threshold = std::numeric_limits<std::size_t>::max();
+  for (std::size_t n = 1; n <= max_size; n *= 2) {
+    const auto t_one = measure(n, [&](ParticleSpan& span) {
+      for (auto&& p : span)
+        process(p);
+    });
+    const auto t_span = measure(n, [&](ParticleSpan& span) { process(span); });
+    if (t_span >= t_one)
+      threshold = std::numeric_limits<std::size_t>::max();
+    else if (threshold == std::numeric_limits<std::size_t>::max())
+      threshold = n;
+  }
+  return threshold;
+}
+
+// calls the process particle by particle for spans below a threshold, which is
+// calibrated on construction, and the span version otherwise
+template <class Process>
+struct Hybrid {
+  static constexpr bool charged_only = is_charged_only<Process>::value;
+  static constexpr FieldSet reads = field_reads<Process>;
+  static constexpr FieldSet writes = field_writes<Process>;
+
+  Process process;
+  std::size_t threshold;
+
+  explicit Hybrid(Process p = {}) : process(p), threshold(calibrate_span_threshold(p)) {}
+
+  template <class T>
+  void operator()(T& p) const { process(p); }
+
+  void operator()(ParticleSpan& span) const {
+    if (span.size() < threshold)
+      for (auto&& p : span)
+        process(p);
+    else
+      process(span);
+  }
+};
+
+// observers only read particles, each keeps its own result
+struct EnergyHistogram {
+  float lo, hi;
+  std::vector<std::size_t> counts;
+  std::size_t non_finite = 0; // NaN or inf energies, which have no bin
+
+  EnergyHistogram(float lo, float hi, std::size_t n_bins) : lo(lo), hi(hi), counts(n_bins, 0) {}
+
+  void operator()(ConstParticleSpan span) {
+    const float scale = counts.size() / (hi - lo);
+    const Eigen::ArrayXf x = (span.e() - lo) * scale;
+    for (auto v : x) {
+      if (std::isfinite(v))
+        ++counts[std::size_t(std::clamp(v, 0.f, float(counts.size() - 1)))];
+      else
+        ++non_finite;
+    }
+  }
+};
+
+struct PositionSummary {
+  Eigen::Array3f min, max, mean;
+
+  void operator()(ConstParticleSpan span) {
+    min << span.x().minCoeff(), span.y().minCoeff(), span.z().minCoeff();
+    max << span.x().maxCoeff(), span.y().maxCoeff(), span.z().maxCoeff();
+    mean << span.x().mean(), span.y().mean(), span.z().mean();
+  }
+};
+
+// synthetic stand-in for an expensive interaction process, which only acts on
+// particles of one type and costs `cost` energy loss calculations per particle
+struct HeavyInteraction {
+  static constexpr FieldSet reads = fields::pid | fields::momentum | fields::e;
+  static constexpr FieldSet writes = fields::e;
+
+  std::int32_t pid;
+  int cost;
+
+  void operator()(ParticleSpan& span) const {
+    for (auto&& p : span)
+      if (p.pid() == pid)
+        for (int i = 0; i < cost; ++i)
+          energy_loss(p);
+  }
+};
+
+using ProcessVariant = std::variant<ContinuousEnergyLoss, ContinuousEnergyLossNoEigen,
+                                    MoveParticle, MoveParticleNoEigen, HeavyInteraction,
+                                    Hybrid<ContinuousEnergyLoss>, Hybrid<MoveParticle>>;
+using ProcessList = std::vector<ProcessVariant>;
+
+// the part of the stack that a process needs to see
+template <class Process>
+ParticleSpan span_for(ChargePartitionedStack& stack, const Process&) {
+  if constexpr (is_charged_only<Process>::value)
+    return stack.charged();
+  else
+    return stack.all();
+}
+
+// synthetic process which splits each particle into itself and k secondaries,
+// which share its energy and momentum equally
+struct EmitSecondaries {
+  static constexpr FieldSet reads = fields::all;
+  static constexpr FieldSet writes = fields::momentum | fields::e;
+
+  std::size_t k;
+
+  std::size_t max_secondaries(std::size_t n_particles) const { return k * n_particles; }
+
+  void operator()(ParticleSpan& span, SecondaryBuffer& secondaries) const {
+    const float f = 1.0f / (k + 1);
+    for (auto&& p : span) {
+      p.px() *= f;
+      p.py() *= f;
+      p.pz() *= f;
+      p.e() *= f;
+      for (std::size_t i = 0; i < k; ++i)
+        secondaries.push_back(p);
+    }
+  }
+};
+
+// dependency graph of a process list, from the declared field access: a process
+// depends on an earlier one if it reads or writes a field which the earlier one
+// writes, or writes a field which the earlier one reads; processes without a path
+// between them may run concurrently, and fields outside of used() need no transpose
+class ProcessGraph {
+public:
+    template <class List>
+    explicit ProcessGraph(const List& process_list) {
+      for (const auto& process : process_list)
+        visit([this](auto& proc) {
+          using P = std::decay_t<decltype(proc)>;
+          reads_.push_back(field_reads<P>);
+          writes_.push_back(field_writes<P>);
+        }, process);
+      const std::size_t n = reads_.size();
+      depends_on_.resize(n);
+      level_.resize(n, 0);
+      for (std::size_t j = 0; j < n; ++j)
+        for (std::size_t i = 0; i < j; ++i)
+          if ((writes_[i] & (reads_[j] | writes_[j])) || (reads_[i] & writes_[j])) {
+            depends_on_[j].push_back(i);
+            level_[j] = std::max(level_[j], level_[i] + 1);
+          }
+    }
+
+    std::size_t size() const { return reads_.size(); }
+
+    FieldSet reads(std::size_t i) const { return reads_[i]; }
+    FieldSet writes(std::size_t i) const { return writes_[i]; }
+
+    const std::vector<std::size_t>& depends_on(std::size_t i) const { return depends_on_[i]; }
+
+    // union of all fields which any process touches
+    FieldSet used() const {
+      FieldSet set = 0;
+      for (std::size_t i = 0; i < size(); ++i)
+        set |= reads_[i] | writes_[i];
+      return set;
+    }
+
+    // processes grouped by their longest dependency chain; the processes within one
+    // level are independent of each other, and all their dependencies are in earlier levels
+    std::vector<std::vector<std::size_t>> levels() const {
+      std::vector<std::vector<std::size_t>> result;
+      for (std::size_t i = 0; i < size(); ++i) {
+        if (level_[i] >= result.size())
+          result.resize(level_[i] + 1);
+        result[level_[i]].push_back(i);
+      }
+      return result;
+    }
+
+private:
+    std::vector<FieldSet> reads_, writes_;
+    std::vector<std::vector<std::size_t>> depends_on_;
+    std::vector<std::size_t> level_;
+};
+
+// processes which create secondaries are called with an extra SecondaryBuffer
+template <class Process>
+constexpr bool creates_secondaries =
+    std::is_invocable<const Process&, ParticleSpan&, SecondaryBuffer&>::value;
+
+using SecondaryProcessVariant = std::variant<ContinuousEnergyLoss, MoveParticle, EmitSecondaries>;
+using SecondaryProcessList = std::vector<SecondaryProcessVariant>;
+
+// upper limit for the number of secondaries from one pass over n particles
+template <class List>
+std::size_t max_secondaries(const List& process_list, std::size_t n_particles) {
+  std::size_t n = 0;
+  for (const auto& process : process_list)
+    visit([&](auto& proc) {
+      if constexpr (creates_secondaries<std::decay_t<decltype(proc)>>)
+        n += proc.max_secondaries(n_particles);
+    }, process);
+  return n;
+}
+
+// one pass of the process list over the span; every process which creates
+// secondaries gets its own buffer from the arena, which must have room for
+// max_secondaries() of the span
+template <class List>
+void run_processes(ParticleSpan span, const List& process_list, SecondaryArena& arena) {
+  for (const auto& process : process_list)
+    visit([&](auto& proc) {
+      if constexpr (creates_secondaries<std::decay_t<decltype(proc)>>)
+        proc(span, arena.allocate(proc.max_secondaries(span.size())));
+      else
+        proc(span);
+    }, process);
+}
+
+// same, with arena storage sized before the pass
+template <class List>
+void apply_processes(ParticleSpan span, const List& process_list, SecondaryArena& arena) {
+  arena.reset(max_secondaries(process_list, span.size()));
+  run_processes(span, process_list, arena);
+}
+
+// one pass of the process list over the stack; the secondaries are merged into the
+// stack after the pass, when no span points into it anymore
+template <class List>
+void step(std::vector<Particle>& stack, const List& process_list, SecondaryArena& arena) {
+  apply_processes(ParticleSpan(stack.data(), stack.data() + stack.size()), process_list, arena);
+  arena.merge_into(stack);
+}
+
+// allocator which default-initializes elements instead of value-initializing them,
+// so that growing a vector of trivial particles does not zero-fill memory which is
+// overwritten right after, e.g. the room for secondaries in the cascade
+template <class T>
+struct DefaultInitAllocator : std::allocator<T> {
+  template <class U>
+  struct rebind {
+    using other = DefaultInitAllocator<U>;
+  };
+
+  using std::allocator<T>::allocator;
+
+  template <class U>
+  void construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value) {
+    ::new (static_cast<void*>(p)) U;
+  }
+
+  template <class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+};
+
+// particle stack of the cascade
+using ParticleStack = std::vector<Particle, DefaultInitAllocator<Particle>>;
+
+// disk spill for the stack: segments from its bottom, which are touched last, are
+// written to an unlinked temporary file through memory maps; when the stack runs
+// empty, the last segment is mapped back in and appended as one contiguous span;
+// file offsets are rounded up to whole pages
+class ParticleSpill {
+public:
+    struct Stats {
+      std::size_t spilled = 0, refilled = 0; // particles
+      double spill_time = 0, refill_time = 0; // in s
+    };
+
+    ParticleSpill(std::size_t max_particles, std::size_t segment_size,
+                  const std::filesystem::path& dir = std::filesystem::temp_directory_path())
+        : max_particles_(max_particles), segment_size_(segment_size),
+          page_size_(sysconf(_SC_PAGESIZE)) {
+      if (segment_size == 0)
+        throw std::invalid_argument("ParticleSpill: segment size must be positive");
+      std::string path = (dir / "particle_spill_XXXXXX").string();
+      fd_ = mkstemp(path.data());
+      if (fd_ < 0)
+        throw std::system_error(errno, std::generic_category(), "mkstemp");
+      unlink(path.c_str()); // the file lives until fd_ is closed
+    }
+
+    ParticleSpill(const ParticleSpill&) = delete;
+    ParticleSpill& operator=(const ParticleSpill&) = delete;
+
+    ~ParticleSpill() { close(fd_); }
+
+    // RAM limit for the stack, including room for the secondaries of a step
+    std::size_t max_particles() const { return max_particles_; }
+
+    std::size_t segment_size() const { return segment_size_; }
+
+    // writes the bottom n particles of the stack to disk, in segments of at most
+    // segment_size() particles, and removes them from the stack with a single erase,
+    // which is not part of the spill time
+    void spill(ParticleStack& stack, std::size_t n) {
+      n = std::min(n, stack.size());
+      const auto t0 = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < n; i += segment_size_) {
+        const std::size_t m = std::min(segment_size_, n - i);
+        const std::size_t bytes = m * sizeof(Particle);
+        const std::size_t offset = segments_.empty() ? 0 : segments_.back().end;
+        if (ftruncate(fd_, offset + bytes) != 0)
+          throw std::system_error(errno, std::generic_category(), "ftruncate");
+        void* p = map(offset, bytes, PROT_WRITE);
+        std::memcpy(p, stack.data() + i, bytes);
+        munmap(p, bytes);
+        segments_.push_back({offset, m, round_up(offset + bytes)});
+      }
+      stats_.spilled += n;
+      stats_.spill_time += seconds_since(t0);
+      stack.erase(stack.begin(), stack.begin() + n);
+    }
+
+    // returns false if there is nothing to refill
+    bool refill(ParticleStack& stack) {
+      if (segments_.empty())
+        return false;
+      const auto t0 = std::chrono::steady_clock::now();
+      const Segment s = segments_.back();
+      segments_.pop_back();
+      const std::size_t bytes = s.n * sizeof(Particle);
+      auto p = static_cast<Particle*>(map(s.offset, bytes, PROT_READ | PROT_WRITE));
+      ParticleSpan span(p, p + s.n);
+      stack.insert(stack.end(), span.begin(), span.end());
+      munmap(p, bytes);
+      if (ftruncate(fd_, s.offset) != 0) // frees the disk space
+        throw std::system_error(errno, std::generic_category(), "ftruncate");
+      stats_.refilled += s.n;
+      stats_.refill_time += seconds_since(t0);
+      return true;
+    }
+
+    std::size_t size() const { // spilled particles
+      std::size_t n = 0;
+      for (auto&& s : segments_)
+        n += s.n;
+      return n;
+    }
+
+    const Stats& stats() const { return stats_; }
+    void reset_stats() { stats_ = Stats(); }
+
+private:
+    struct Segment {
+      std::size_t offset, n, end; // end is page-aligned, the offset of the next segment
+    };
+
+    void* map(std::size_t offset, std::size_t bytes, int prot) {
+      void* p = mmap(nullptr, bytes, prot, MAP_SHARED, fd_, offset);
+      if (p == MAP_FAILED)
+        throw std::system_error(errno, std::generic_category(), "mmap");
+      return p;
+    }
+
+    std::size_t round_up(std::size_t bytes) const {
+      return (bytes + page_size_ - 1) / page_size_ * page_size_;
+    }
+
+    static double seconds_since(std::chrono::steady_clock::time_point t0) {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    std::size_t max_particles_, segment_size_, page_size_;
+    int fd_;
+    std::vector<Segment> segments_;
+    Stats stats_;
+};
+
+// span-size policies tell the cascade how many particles to take from the top of
+// the non-empty stack in the next step; they may reorder the stack
+struct WholeStackPolicy {
+  std::size_t operator()(ParticleStack& stack) const { return stack.size(); }
+};
+
+struct FixedSpanPolicy {
+  std::size_t span_size;
+
+  std::size_t operator()(ParticleStack& stack) const {
+    return std::min(stack.size(), span_size);
+  }
+};
+
+// breadth-first while the stack fits into the memory budget; beyond it, depth-first
+// on spans of the lowest-energy particles, which have the fewest descendants: the
+// stack is sorted once by falling energy, afterwards the secondaries on top have less
+// energy than their parents anyway; the budget is soft, a breadth-first step may
+// overshoot it, use the byte cap of the cascade for a hard limit
+struct MemoryBoundedPolicy {
+  std::size_t budget_bytes;
+  std::size_t span_size = 256;
+  bool depth_first = false;
+
+  std::size_t operator()(ParticleStack& stack) {
+    if (stack.size() * sizeof(Particle) <= budget_bytes) {
+      depth_first = false;
+      return stack.size();
+    }
+    if (!depth_first) {
+      std::sort(stack.begin(), stack.end(),
+                [](const Particle& a, const Particle& b) { return a.e() > b.e(); });
+      depth_first = true;
+    }
+    return std::min(stack.size(), span_size);
+  }
+};
+
+struct CascadeStats {
+  std::size_t steps = 0;
+  std::size_t particle_steps = 0; // sum of all span sizes
+  std::size_t secondaries = 0;
+  std::size_t peak_stack_size = 0;
+  std::size_t peak_bytes = 0; // stack and room for secondaries, while the processes run
+  std::size_t peak_capacity_bytes = 0; // allocated by the stack
+
+  double average_span_size() const { return steps ? double(particle_steps) / steps : 0; }
+};
+
+// main loop: takes a span from the top of the stack, runs the process list on it,
+// appends the secondaries, drops particles below the energy cut (or with NaN energy)
+// and repeats until the stack is empty; the secondaries are written straight into the
+// tail of the stack, so the stack holds all particle memory of the cascade; with a
+// byte cap, the stack gets a buffer of exactly max_bytes, which never reallocates, and
+// the span from the policy is shrunk until the stack and the room for the secondaries
+// of the step fit into it (the compactor needs another byte per particle of the span)
+template <class Policy = WholeStackPolicy, class List = SecondaryProcessList>
+class Cascade {
+public:
+    Cascade(List process_list, float energy_cut, Policy policy = {},
+            std::size_t max_bytes = std::numeric_limits<std::size_t>::max())
+        : process_list_(std::move(process_list)), energy_cut_(energy_cut), policy_(policy),
+          max_bytes_(max_bytes) {}
+
+    CascadeStats run(ParticleStack& stack) {
+      CascadeStats stats;
+      reserve(stack);
+      while (!stack.empty())
+        step(stack, stats);
+      return stats;
+    }
+
+    // keeps the stack and the room for the secondaries of each step in RAM below the
+    // limit of the spill, refills the stack when it is empty
+    CascadeStats run(ParticleStack& stack, ParticleSpill& spill) {
+      CascadeStats stats;
+      reserve(stack);
+      do {
+        while (!stack.empty())
+          step(stack, stats, &spill);
+      } while (spill.refill(stack));
+      return stats;
+    }
+
+private:
+    bool capped() const { return max_bytes_ != std::numeric_limits<std::size_t>::max(); }
+    std::size_t max_particles() const { return max_bytes_ / sizeof(Particle); }
+
+    void reserve(ParticleStack& stack) const {
+      if (!capped() || stack.capacity() == max_particles())
+        return;
+      if (stack.size() > max_particles())
+        throw std::length_error("Cascade: stack exceeds byte cap");
+      ParticleStack s;
+      s.reserve(max_particles());
+      s.assign(stack.begin(), stack.end());
+      stack.swap(s);
+    }
+
+    // particles below the span go to the spill first, then the span is shrunk
+    void step(ParticleStack& stack, CascadeStats& stats, ParticleSpill* spill = nullptr) {
+      std::size_t n = policy_(stack);
+      const std::size_t limit =
+          spill ? std::min(max_particles(), spill->max_particles()) : max_particles();
+      auto fits = [&](std::size_t n) {
+        return stack.size() + max_secondaries(process_list_, n) <= limit;
+      };
+      while (!fits(n)) {
+        if (spill && stack.size() > n) {
+          // whole segments, as many as needed to fit, but none from the span
+          const std::size_t excess = stack.size() + max_secondaries(process_list_, n) - limit;
+          const std::size_t segment = spill->segment_size();
+          spill->spill(stack, std::min((excess + segment - 1) / segment * segment,
+                                       stack.size() - n));
+        } else if (n > 1)
+          n /= 2;
+        else
+          throw std::length_error(spill ? "Cascade: span exceeds spill limit"
+                                        : "Cascade: stack exceeds byte cap");
+      }
+      const std::size_t top = stack.size() - n;
+      const std::size_t capacity = max_secondaries(process_list_, n);
+      stack.resize(stack.size() + capacity); // room for secondaries, not zero-filled
+      stats.peak_bytes = std::max(stats.peak_bytes, stack.size() * sizeof(Particle));
+      stats.peak_capacity_bytes =
+          std::max(stats.peak_capacity_bytes, stack.capacity() * sizeof(Particle));
+      arena_.reset(stack.data() + top + n, capacity);
+      run_processes(ParticleSpan(stack.data() + top, stack.data() + top + n), process_list_, arena_);
+      stats.secondaries += arena_.size();
+      stack.resize(top + n + arena_.pack());
+      // the cut applies to the processed particles and their secondaries alike
+      ParticleSpan span(stack.data() + top, stack.data() + stack.size());
+      stack.resize(top + compact_(span, !(span.e() >= energy_cut_), false));
+      ++stats.steps;
+      stats.particle_steps += n;
+      stats.peak_stack_size = std::max(stats.peak_stack_size, stack.size());
+    }
+
+    List process_list_;
+    float energy_cut_;
+    Policy policy_;
+    std::size_t max_bytes_;
+    SecondaryArena arena_;
+    Compactor compact_;
+};
+
+// primary particle for synthetic showers, with beta^2 = 0.9
+Particle make_primary(float energy) {
+  Particle p{};
+  p.pid() = pid_from_pdg(2212);
+  p.e() = energy;
+  p.pz() = std::sqrt(0.9f) * energy;
+  return p;
+}
+
+// process list for synthetic showers: every particle moves and splits into two, until
+// it falls below the energy cut; energy loss is left out, since the toy formula does
+// not update the momentum and pushes particles beyond beta = 1 within a few steps
+SecondaryProcessList synthetic_shower_processes() {
+  SecondaryProcessList process_list;
+  process_list.emplace_back(MoveParticle());
+  process_list.emplace_back(EmitSecondaries{1});
+  return process_list;
+}
+
+// chunks of this many particles fit into half of a typical 32 KiB L1 or 256 KiB L2 cache
+constexpr std::size_t l1_chunk_size = 16 * 1024 / sizeof(Particle);
+constexpr std::size_t l2_chunk_size = 128 * 1024 / sizeof(Particle);
+
+// holds particles in front of an expensive process until at least min_batch particles
+// are waiting or the oldest one has waited max_steps steps, and then runs the process
+// on all of them with a single call; processed particles are appended to an output
+class BatchingStage {
+public:
+    struct Stats {
+      std::size_t calls = 0;
+      std::size_t particles = 0;
+      std::size_t latency = 0; // sum over particles of the steps spent waiting
+    };
+
+    BatchingStage(ProcessVariant process, std::size_t min_batch, std::size_t max_steps)
+        : process_(process), min_batch_(min_batch), max_steps_(max_steps) {
+      buffer_.reserve(min_batch);
+    }
+
+    // takes copies of the particles, they leave the stack until they are flushed
+    void push(ParticleSpan span) {
+      if (span.size() == 0)
+        return;
+      buffer_.insert(buffer_.end(), span.begin(), span.end());
+      arrivals_.emplace_back(step_, span.size());
+    }
+
+    // ends the current step; returns true if the batch was flushed into out
+    bool end_step(std::vector<Particle>& out) {
+      const bool due = buffer_.size() >= min_batch_ ||
+                       (!arrivals_.empty() && step_ - arrivals_.front().first + 1 >= max_steps_);
+      if (due)
+        flush(out);
+      ++step_;
+      return due;
+    }
+
+    void flush(std::vector<Particle>& out) {
+      if (buffer_.empty())
+        return;
+      ParticleSpan span(buffer_.data(), buffer_.data() + buffer_.size());
+      visit([&span](auto& proc) { proc(span); }, process_);
+      ++stats_.calls;
+      stats_.particles += buffer_.size();
+      for (auto&& [step, n] : arrivals_)
+        stats_.latency += n * (step_ - step);
+      out.insert(out.end(), buffer_.begin(), buffer_.end());
+      buffer_.clear();
+      arrivals_.clear();
+    }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    ProcessVariant process_;
+    std::size_t min_batch_, max_steps_;
+    std::vector<Particle> buffer_;
+    std::vector<std::pair<std::size_t, std::size_t>> arrivals_; // step, number of particles
+    std::size_t step_ = 0;
+    Stats stats_;
+};
+
+// applies all processes to the i-th chunk of the span
+void process_chunk(ParticleSpan span, std::size_t i, std::size_t chunk_size,
+                   const ProcessList& process_list) {
+  const auto b = span.begin() + i * chunk_size;
+  ParticleSpan chunk(b, b + std::min(chunk_size, span.size() - i * chunk_size));
+  for (const auto& process : process_list)
+    visit([&chunk](auto& proc) { proc(chunk); }, process);
+}
+
+std::size_t n_chunks(ParticleSpan span, std::size_t chunk_size) {
+  return (span.size() + chunk_size - 1) / chunk_size;
+}
+
+// runs the process list over the span tile by tile on the calling thread, applying
+// all processes to a tile while it is still in cache before moving on to the next
+void tiled_process(ParticleSpan span, const ProcessList& process_list,
+                   std::size_t tile_size = l2_chunk_size) {
+  for (std::size_t i = 0, n = n_chunks(span, tile_size); i < n; ++i)
+    process_chunk(span, i, tile_size, process_list);
+}
+
+// physics list which is fixed at compile time, so there is no std::variant dispatch;
+// the fold expressions unroll the list into one loop body, in which the compiler can
+// fuse the processes and keep intermediate values in registers
+template <class... Processes>
+class StaticProcessList {
+public:
+    explicit StaticProcessList(Processes... processes) : processes_(processes...) {}
+
+    // all processes are applied to one particle before moving to the next
+    void operator()(ParticleSpan& span) const {
+      for (auto&& p : span)
+        std::apply([&p](const auto&... proc) { (proc(p), ...); }, processes_);
+    }
+
+    // all processes are applied to one tile of the span before moving to the next
+    void tiled(ParticleSpan span, std::size_t tile_size = l1_chunk_size) const {
+      for (auto b = span.begin(); b < span.end(); b += tile_size) {
+        ParticleSpan tile(b, b + std::min<std::size_t>(tile_size, span.end() - b));
+        std::apply([&tile](const auto&... proc) { (proc(tile), ...); }, processes_);
+      }
+    }
+
+private:
+    std::tuple<Processes...> processes_;
+};
+
+// runs the process list over the span in chunks, which are spread over the pool;
+// all processes are applied to a chunk before the thread moves on to the next
+void parallel_process(ThreadPool& pool, ParticleSpan span, const ProcessList& process_list,
+                      std::size_t chunk_size = l2_chunk_size) {
+  pool.parallel_for(n_chunks(span, chunk_size), [&](std::size_t i) {
+    process_chunk(span, i, chunk_size, process_list);
+  });
+}
+
+// double-buffered stack for out-of-place stepping: a step reads generation k from one
+// buffer and writes the survivors and secondaries as generation k+1 into the other;
+// the buffers only grow, so after warm-up nothing is allocated
+class GenerationalStack {
+public:
+    void assign(const Particle* b, const Particle* e) {
+      size_ = e - b;
+      if (current_.size() < size_)
+        current_.resize(size_);
+      std::copy(b, e, current_.begin());
+    }
+
+    ParticleSpan span() { return {current_.data(), current_.data() + size_}; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // makes room for n particles in the next generation
+    Particle* next(std::size_t n) {
+      if (next_.size() < n)
+        next_.resize(n);
+      next_size_ = n;
+      return next_.data();
+    }
+
+    // the next generation becomes the current one
+    void swap() {
+      std::swap(current_, next_);
+      size_ = next_size_;
+    }
+
+private:
+    std::vector<Particle> current_, next_;
+    std::size_t size_ = 0, next_size_ = 0;
+};
+
+// out-of-place version of Cascade, which processes the whole generation in each step:
+// every thread runs the process list on its chunk with its own arena and counts the
+// particles above the energy cut; an exclusive prefix sum over the counts gives the
+// offsets at which the threads write survivors and secondaries, without locks
+template <class List = SecondaryProcessList>
+class GenerationalCascade {
+public:
+    GenerationalCascade(ThreadPool& pool, List process_list, float energy_cut)
+        : pool_(pool), process_list_(std::move(process_list)), energy_cut_(energy_cut),
+          arenas_(pool.size()), offset_(pool.size() + 1, 0) {}
+
+    CascadeStats run(GenerationalStack& stack) {
+      CascadeStats stats;
+      while (!stack.empty()) {
+        stats.particle_steps += stack.size();
+        stats.secondaries += step(stack);
+        ++stats.steps;
+        stats.peak_stack_size = std::max(stats.peak_stack_size, stack.size());
+      }
+      return stats;
+    }
+
+    // returns the number of secondaries, before the energy cut
+    std::size_t step(GenerationalStack& stack) {
+      ParticleSpan span = stack.span();
+      const std::size_t n = span.size();
+      const std::size_t n_chunks = arenas_.size();
+      auto chunk = [&](std::size_t k) {
+        return ParticleSpan(span.begin() + n * k / n_chunks, span.begin() + n * (k + 1) / n_chunks);
+      };
+
+      pool_.parallel_for(n_chunks, [&](std::size_t k) {
+        auto c = chunk(k);
+        apply_processes(c, process_list_, arenas_[k]);
+        std::size_t m = (c.e() >= energy_cut_).count();
+        arenas_[k].for_each_span([&](ParticleSpan s) { m += (s.e() >= energy_cut_).count(); });
+        offset_[k + 1] = m;
+      });
+      std::partial_sum(offset_.begin(), offset_.end(), offset_.begin());
+
+      Particle* out = stack.next(offset_.back());
+      std::size_t n_secondaries = 0;
+      for (auto&& arena : arenas_)
+        n_secondaries += arena.size();
+      pool_.parallel_for(n_chunks, [&](std::size_t k) {
+        Particle* o = out + offset_[k];
+        auto copy = [&](ParticleSpan s) {
+          for (auto&& p : s)
+            if (p.e() >= energy_cut_)
+              *o++ = p;
+        };
+        copy(chunk(k));
+        arenas_[k].for_each_span(copy);
+      });
+      stack.swap();
+      return n_secondaries;
+    }
+
+private:
+    ThreadPool& pool_;
+    List process_list_;
+    float energy_cut_;
+    std::vector<SecondaryArena> arenas_; // one per chunk
+    std::vector<std::size_t> offset_;
+};
+
+// each worker starts with a contiguous range of tasks and takes tasks from its front;
+// a worker which runs out steals the back half of the range of another worker
+class WorkStealingScheduler {
+public:
+    // padded to a cache line, each is written by its own thread
+    struct alignas(64) WorkerStats {
+      std::size_t tasks = 0;
+      std::size_t steals = 0;
+      double idle = 0; // in s, time between running out of work and the end of run()
+    };
+
+    explicit WorkStealingScheduler(ThreadPool& pool)
+        : pool_(pool), queues_(pool.size()), stats_(pool.size()) {}
+
+    // calls f(i) for all i in [0, n); queue k is worked by thread k of the pool,
+    // without stealing, this is a static split
+    template <class F>
+    void run(std::size_t n, F&& f, bool steal = true) {
+      using clock = std::chrono::steady_clock;
+      const std::size_t w = queues_.size();
+      for (std::size_t k = 0; k < w; ++k) {
+        queues_[k].begin = n * k / w;
+        queues_[k].end = n * (k + 1) / w;
+      }
+      std::vector<clock::time_point> finish(w);
+      pool_.for_each_thread([&](std::size_t k) {
+        std::size_t task;
+        while (pop(k, task) || (steal && steal_into(k, task))) {
+          f(task);
+          ++stats_[k].tasks;
+        }
+        finish[k] = clock::now();
+      });
+      const auto end = clock::now();
+      for (std::size_t k = 0; k < w; ++k)
+        stats_[k].idle += std::chrono::duration<double>(end - finish[k]).count();
+    }
+
+    const std::vector<WorkerStats>& stats() const { return stats_; }
+    void reset_stats() { std::fill(stats_.begin(), stats_.end(), WorkerStats()); }
+
+private:
+    struct alignas(64) Queue {
+      std::mutex mutex;
+      std::size_t begin = 0, end = 0;
+    };
+
+    bool pop(std::size_t k, std::size_t& task) {
+      auto& q = queues_[k];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      if (q.begin == q.end)
+        return false;
+      task = q.begin++;
+      return true;
+    }
+
+    bool steal_into(std::size_t k, std::size_t& task) {
+      const std::size_t w = queues_.size();
+      for (std::size_t i = 1; i < w; ++i) {
+        auto& victim = queues_[(k + i) % w];
+        std::size_t b, e;
+        {
+          std::lock_guard<std::mutex> lock(victim.mutex);
+          if (victim.begin == victim.end)
+            continue;
+          b = victim.end - (victim.end - victim.begin + 1) / 2;
+          e = victim.end;
+          victim.end = b;
+        }
+        {
+          auto& q = queues_[k];
+          std::lock_guard<std::mutex> lock(q.mutex);
+          q.begin = b + 1;
+          q.end = e;
+        }
+        task = b;
+        ++stats_[k].steals;
+        return true;
+      }
+      return false;
+    }
+
+    ThreadPool& pool_;
+    std::vector<Queue> queues_;
+    std::vector<WorkerStats> stats_;
+};
+
+// runs the independent processes of each level of the graph concurrently on the pool,
+// each over the whole span
+void concurrent_process(ThreadPool& pool, ParticleSpan span, const ProcessList& process_list,
+                        const ProcessGraph& graph) {
+  for (const auto& level : graph.levels())
+    pool.parallel_for(level.size(), [&](std::size_t k) {
+      ParticleSpan s = span;
+      visit([&s](auto& proc) { proc(s); }, process_list[level[k]]);
+    });
+}
+
+// like parallel_process, but the chunks are scheduled by work stealing
+void work_stealing_process(WorkStealingScheduler& scheduler, ParticleSpan span,
+                           const ProcessList& process_list,
+                           std::size_t chunk_size = l2_chunk_size, bool steal = true) {
+  scheduler.run(n_chunks(span, chunk_size), [&](std::size_t i) {
+    process_chunk(span, i, chunk_size, process_list);
+  }, steal);
+}
+
+// Method 1: process one particle at once
+static void process_one(benchmark::State& state) {
+  auto stack = setup_stack();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  for (auto _ : state) {
+    for (auto&& p : span) {
+      energy_loss(p);   
+      move_particle(p);
+    }
+  }
+}
+
+// Method 2: process block of particles at once
+static void process_span(benchmark::State& state) {
+  auto stack = setup_stack();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  for (auto _ : state) {
+    energy_loss(span);
+    move_particle(span);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// Method 2B: like Method 2, but with structure-of-arrays storage
+static void process_span_soa(benchmark::State& state) {
+  auto aos = setup_stack();
+  ParticleStackSoA stack(aos);
+
+  ParticleSpanSoA span(stack, 0, state.range(0));
+
+  for (auto _ : state) {
+    energy_loss(span);
+    move_particle(span);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// Method 2E: like Method 2B, but with explicit SIMD kernels of N floats per pack
+template <int N>
+static void process_span_simd(benchmark::State& state) {
+  auto aos = setup_stack();
+  ParticleStackSoA stack(aos);
+
+  ParticleSpanSoA span(stack, 0, state.range(0));
+
+  for (auto _ : state) {
+    energy_loss_simd<N>(span);
+    move_particle_simd<N>(span);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// Method 2C: like Method 2, but with tiled (AoSoA) storage of tile width W
+template <int W>
+static void process_span_aosoa(benchmark::State& state) {
+  auto aos = setup_stack();
+  ParticleStackAoSoA<W> stack(aos);
+
+  ParticleSpanAoSoA<W> span(stack, 0, state.range(0));
+
+  for (auto _ : state) {
+    ContinuousEnergyLoss()(span);
+    MoveParticle()(span);
+  }
+}
+
+// Method 1D: like Method 1, but with particles padded to 64 bytes
+static void process_one_padded(benchmark::State& state) {
+  auto stack = setup_stack<PaddedParticle>();
+
+  PaddedParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  for (auto _ : state) {
+    for (auto&& p : span) {
+      energy_loss(p);
+      move_particle(p);
+    }
+  }
+}
+
+// Method 2D: like Method 2, but with particles padded to 64 bytes
+static void process_span_padded(benchmark::State& state) {
+  auto stack = setup_stack<PaddedParticle>();
+
+  PaddedParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  for (auto _ : state) {
+    energy_loss(span);
+    move_particle(span);
+  }
+}
+
+// Method 2F: like Method 2, with configurable accuracy of the log in energy loss
+template <LogAccuracy A>
+static void process_span_log(benchmark::State& state) {
+  auto stack = setup_stack();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const BasicContinuousEnergyLoss<A> eloss;
+  for (auto _ : state) {
+    eloss(span);
+    move_particle(span);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
 }
 
-decltype(auto) charge(ParticleSpan& part) {
-  // this could be a complicated function or a lookup table
-  return (part.pid() != 0).template cast<float>();
-}
+// Method 2G: like Method 2F, but with structure-of-arrays storage; the charge lookup
+// in energy_loss has no packet version, so Eigen still evaluates the whole
+// expression, including the log, element by element
+template <LogAccuracy A>
+static void process_span_soa_log(benchmark::State& state) {
+  auto aos = setup_stack();
+  ParticleStackSoA stack(aos);
 
-// note: this function body looks the same whether we pass one particle or a span!
-template <class T>
-void energy_loss(T& part) {
-  decltype(auto) beta_2 = momentum_squared(part) / sqr(part.e());
-  // compute energy loss, ignoring all constants
-  using std::log; // allow Eigen to find its own log via ADL
-  decltype(auto) energy_loss = charge(part) * (log(beta_2 / (1.0 - beta_2)) / beta_2 - 1.0);
-  part.e() -= energy_loss;
-}
+  ParticleSpanSoA span(stack, 0, state.range(0));
 
-// ... nevertheless we try a special one particle version for comparison
-void energy_loss(Particle& part) {
-  auto beta_2 = momentum_squared(part) / sqr(part.e());
-  const auto c = charge(part);
-  if (c != 0) {
-    // compute energy loss, ignoring all constants
-    const auto energy_loss = c * (std::log(beta_2 / (1.0 - beta_2)) / beta_2 - 1.0);
-    part.e() -= energy_loss;    
+  const BasicContinuousEnergyLoss<A> eloss;
+  for (auto _ : state) {
+    eloss(span);
+    move_particle(span);
   }
+  state.SetItemsProcessed(state.iterations() * span.size());
 }
 
-// note: again function body looks the same whether we pass one particle or a span
-template <class T>
-void move_particle(T& p) {
-  const auto dt = 0.1;
-  p.x() += p.px() * dt;
-  p.y() += p.py() * dt;
-  p.z() += p.pz() * dt;
-  p.t() += dt;
+// cost of the charge lookup for a realistic mix of particle types, compared to the
+// former predicate pid != 0, which could only tell charged from neutral particles
+template <bool Lookup>
+static void charge_span(benchmark::State& state) {
+  auto aos = setup_realistic_stack();
+  ParticleStackSoA stack(aos);
+
+  ParticleSpanSoA span(stack, 0, state.range(0));
+
+  Eigen::ArrayXf q(span.size());
+  for (auto _ : state) {
+    if constexpr (Lookup)
+      q = charge(span);
+    else
+      q = (span.pid() != 0).template cast<float>();
+    benchmark::DoNotOptimize(q.data());
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
 }
 
-struct ContinuousEnergyLoss {
-  template <class T>
-  void operator()(T& p) const { energy_loss(p); }
-};
+// Method 2H: like Method 2, but with a realistic mix of particle types
+static void process_span_realistic(benchmark::State& state) {
+  auto stack = setup_realistic_stack();
 
-struct ContinuousEnergyLossNoEigen {
-  void operator()(ParticleSpan& span) const {
-    for (auto&& p : span)
-      energy_loss(p);
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  for (auto _ : state) {
+    energy_loss(span);
+    move_particle(span);
   }
-};
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
 
-struct MoveParticle {
-  template <class T>
-  void operator()(T& p) const { move_particle(p); }
-};
+// throughput of the log functors and their accuracy with respect to std::log in
+// double precision, over the argument of the log in energy_loss for the physical
+// range 0 < beta^2 < 1
+template <class Log>
+static void log_accuracy(benchmark::State& state) {
+  const Eigen::Index n = 10000;
+  const Eigen::ArrayXf beta_2 = Eigen::ArrayXf::LinSpaced(n, 1e-4f, 1 - 1e-4f);
+  const Eigen::ArrayXf x = beta_2 / (1.0f - beta_2);
 
-struct MoveParticleNoEigen {
-  void operator()(ParticleSpan& span) const {
-    for (auto&& p : span)
-      move_particle(p);
+  const Log log;
+  Eigen::ArrayXf y = log(x);
+  double max_abs_err = 0, max_rel_err = 0;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    const double ref = std::log(double(x[i]));
+    const double err = std::abs(y[i] - ref);
+    max_abs_err = std::max(max_abs_err, err);
+    if (ref != 0)
+      max_rel_err = std::max(max_rel_err, err / std::abs(ref));
   }
-};
 
-using ProcessVariant = std::variant<ContinuousEnergyLoss, ContinuousEnergyLossNoEigen,
-                                    MoveParticle, MoveParticleNoEigen>;
-using ProcessList = std::vector<ProcessVariant>;
+  for (auto _ : state) {
+    y = log(x);
+    benchmark::DoNotOptimize(y.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["max_abs_err"] = max_abs_err;
+  state.counters["max_rel_err"] = max_rel_err;
+}
 
-// Method 1: process one particle at once
-static void process_one(benchmark::State& state) {
+// Method 2O: like Method 2, but the span is processed in fixed-size blocks of up to
+// N particles
+template <int N>
+static void process_span_fixed(benchmark::State& state) {
   auto stack = setup_stack();
 
   ParticleSpan span(stack.data(), stack.data() + state.range(0));
 
+  for (auto _ : state)
+    for_each_fixed_block<N>(span, [](auto& block) {
+      energy_loss(block);
+      move_particle(block);
+    });
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// energy loss alone on large stacks, with the AoS ParticleSpan or the hot/cold split
+template <bool HotCold>
+static void energy_loss_only(benchmark::State& state) {
+  auto aos = setup_stack(state.range(0));
+  ParticleStackHotCold hot_cold(aos);
+
+  ParticleSpan span(aos.data(), aos.data() + aos.size());
+  ParticleSpanHotCold span_hc(hot_cold, 0, hot_cold.size());
+
   for (auto _ : state) {
-    for (auto&& p : span) {
-      energy_loss(p);   
-      move_particle(p);
-    }
+    if constexpr (HotCold)
+      energy_loss(span_hc);
+    else
+      energy_loss(span);
   }
+  state.SetItemsProcessed(state.iterations() * span.size());
 }
 
-// Method 2: process block of particles at once
-static void process_span(benchmark::State& state) {
-  auto stack = setup_stack();
+// like energy_loss_only, but for move_particle
+template <bool HotCold>
+static void move_particle_only(benchmark::State& state) {
+  auto aos = setup_stack(state.range(0));
+  ParticleStackHotCold hot_cold(aos);
 
-  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+  ParticleSpan span(aos.data(), aos.data() + aos.size());
+  ParticleSpanHotCold span_hc(hot_cold, 0, hot_cold.size());
 
   for (auto _ : state) {
-    energy_loss(span);
-    move_particle(span);
+    if constexpr (HotCold)
+      move_particle(span_hc);
+    else
+      move_particle(span);
   }
+  state.SetItemsProcessed(state.iterations() * span.size());
 }
 
 // Method 3: like Method 2, but don't use Eigen
@@ -195,6 +2453,7 @@ static void process_span_no_eigen(benchmark::State& state) {
       move_particle(p);
     }
   }
+  state.SetItemsProcessed(state.iterations() * span.size());
 }
 
 // Method 1A: process one particle at once using std::variant of processes
@@ -246,9 +2505,563 @@ static void variant_process_span_no_eigen(benchmark::State& state) {
       visit([&span](auto& proc) { proc(span); }, process);
 }
 
+// Method 2I: like Method 2A, but processes only see the particles they act on
+static void variant_process_span_partitioned(benchmark::State& state) {
+  auto particles = setup_stack();
+  particles.resize(state.range(0));
+  ChargePartitionedStack stack(std::move(particles));
+
+  ProcessList process_list;
+  process_list.emplace_back(ContinuousEnergyLoss());
+  process_list.emplace_back(MoveParticle());
+
+  for (auto _ : state)
+    for (const auto& process : process_list)
+      visit([&stack](auto& proc) {
+        auto span = span_for(stack, proc);
+        proc(span);
+      }, process);
+  state.SetItemsProcessed(state.iterations() * stack.size());
+}
+
+// stack in which a fraction of Percent of the particles are protons, the rest neutrons
+template <int Percent>
+auto setup_selection_stack() {
+  auto stack = setup_stack();
+  std::mt19937 rng(1);
+  std::bernoulli_distribution is_proton(Percent / 100.0);
+  for (auto&& part : stack)
+    part.pid() = pid_from_pdg(is_proton(rng) ? 2212 : 2112);
+  return stack;
+}
+
+// energy loss of protons only, via a selection vector and gather-compute-scatter
+template <int Percent>
+static void filtered_energy_loss(benchmark::State& state) {
+  auto stack = setup_selection_stack<Percent>();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const auto proton = pid_from_pdg(2212);
+  FilteredSpan filtered;
+  for (auto _ : state) {
+    filtered.select(span, span.pid() == proton);
+    filtered.apply([](auto& s) { energy_loss(s); });
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// energy loss of protons only, computed for all particles and blended with a mask
+template <int Percent>
+static void masked_energy_loss(benchmark::State& state) {
+  auto stack = setup_selection_stack<Percent>();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const auto proton = pid_from_pdg(2212);
+  Eigen::Array<bool, Eigen::Dynamic, 1> mask(span.size());
+  Eigen::ArrayXf e(span.size());
+  for (auto _ : state) {
+    mask = span.pid() == proton;
+    e = span.e();
+    energy_loss(span);
+    span.e() = mask.select(span.e(), e);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// stack in which a fraction of Percent of the particles falls below the energy cut
+// of 0.01 * Percent
+auto setup_kill_stack(int percent) {
+  auto stack = setup_stack();
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> energy(0, 1);
+  for (auto&& part : stack)
+    part.e() = energy(rng);
+  return std::make_pair(stack, 0.01f * percent);
+}
+
+// compaction of the whole stack after a step, for a kill fraction in percent
+template <bool KeepOrder>
+static void compact_stack(benchmark::State& state) {
+  const auto [orig, cut] = setup_kill_stack(state.range(0));
+  auto stack = orig;
+
+  Compactor compact;
+  for (auto _ : state) {
+    state.PauseTiming();
+    stack = orig;
+    state.ResumeTiming();
+    ParticleSpan span(stack.data(), stack.data() + stack.size());
+    stack.resize(compact(span, !(span.e() >= cut), KeepOrder));
+  }
+  state.SetItemsProcessed(state.iterations() * orig.size());
+}
+
+static void compact_stack_parallel(benchmark::State& state) {
+  auto [stack, cut] = setup_kill_stack(state.range(0));
+  std::vector<Particle> out;
+
+  ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+  Compactor compact;
+  for (auto _ : state) {
+    ParticleSpan span(stack.data(), stack.data() + stack.size());
+    compact.parallel(pool, span, !(span.e() >= cut), out);
+  }
+  state.SetItemsProcessed(state.iterations() * stack.size());
+  state.counters["threads"] = pool.size();
+}
+
+// one step with a process that creates k secondaries per particle, including the
+// merge into the stack; the stack is truncated to its original size afterwards
+static void step_with_secondaries(benchmark::State& state) {
+  const std::size_t n = state.range(0);
+  auto stack = setup_stack();
+  stack.resize(n);
+  stack.reserve(n * (state.range(1) + 1));
+
+  SecondaryProcessList process_list;
+  process_list.emplace_back(ContinuousEnergyLoss());
+  process_list.emplace_back(MoveParticle());
+  process_list.emplace_back(EmitSecondaries{std::size_t(state.range(1))});
+
+  SecondaryArena arena;
+  for (auto _ : state) {
+    step(stack, process_list, arena);
+    stack.resize(n);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Method 2J: like Method 2A, with the span split into chunks over a thread pool;
+// arguments are the number of particles and the number of threads
+static void parallel_variant_process_span(benchmark::State& state) {
+  auto stack = setup_stack(state.range(0));
+
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  ProcessList process_list;
+  process_list.emplace_back(ContinuousEnergyLoss());
+  process_list.emplace_back(MoveParticle());
+
+  ThreadPool pool(state.range(1));
+  for (auto _ : state)
+    parallel_process(pool, span, process_list);
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// stack sizes from 1e4 to 1e7 and thread counts from 1 to all cores
+static void thread_scaling_args(benchmark::internal::Benchmark* b) {
+  const int n_cores = std::max(1u, std::thread::hardware_concurrency());
+  for (int n = 10000; n <= 10000000; n *= 10) {
+    for (int t = 1; t < n_cores; t *= 2)
+      b->Args({n, t});
+    b->Args({n, n_cores});
+  }
+}
+
+// Method 2K: like Method 2J, with a skewed cost distribution, where all expensive
+// particles are in the first eighth of the stack; arguments are the number of threads
+// and whether to steal work (otherwise chunks are split statically)
+static void skewed_process_span(benchmark::State& state) {
+  auto stack = setup_stack(1000000);
+  const auto proton = pid_from_pdg(2212);
+  for (std::size_t i = 0; i < stack.size() / 8; ++i)
+    stack[i].pid() = proton;
+
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  ProcessList process_list;
+  process_list.emplace_back(ContinuousEnergyLoss());
+  process_list.emplace_back(MoveParticle());
+  process_list.emplace_back(HeavyInteraction{proton, 20});
+
+  ThreadPool pool(state.range(0));
+  WorkStealingScheduler scheduler(pool);
+  for (auto _ : state)
+    work_stealing_process(scheduler, span, process_list, 1024, state.range(1));
+  state.SetItemsProcessed(state.iterations() * span.size());
+
+  double idle = 0, max_idle = 0;
+  std::size_t steals = 0;
+  for (auto&& s : scheduler.stats()) {
+    idle += s.idle;
+    max_idle = std::max(max_idle, s.idle);
+    steals += s.steals;
+  }
+  const double n = state.iterations();
+  state.counters["steals"] = steals / n;
+  state.counters["idle_mean"] = idle / n / pool.size();
+  state.counters["idle_max"] = max_idle / n;
+}
+
+// thread counts from 1 to all cores, each with and without work stealing
+static void skewed_args(benchmark::internal::Benchmark* b) {
+  const int n_cores = std::max(1u, std::thread::hardware_concurrency());
+  for (int steal = 0; steal < 2; ++steal) {
+    for (int t = 1; t < n_cores; t *= 2)
+      b->Args({t, steal});
+    b->Args({n_cores, steal});
+  }
+}
+
+// Method 2L: like Method 2A, but the processes are applied tile by tile; a tile size
+// of 0 means no tiling, each process sees the whole span
+template <std::size_t TileSize>
+static void variant_process_span_tiled(benchmark::State& state) {
+  auto stack = setup_stack(state.range(0));
+
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  ProcessList process_list;
+  process_list.emplace_back(ContinuousEnergyLoss());
+  process_list.emplace_back(MoveParticle());
+
+  for (auto _ : state) {
+    if (TileSize == 0)
+      for (const auto& process : process_list)
+        visit([&span](auto& proc) { proc(span); }, process);
+    else
+      tiled_process(span, process_list, TileSize);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// Method 1B: like Method 1A, but with a list of processes fixed at compile time
+static void static_process_one(benchmark::State& state) {
+  auto stack = setup_stack();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const StaticProcessList<ContinuousEnergyLoss, MoveParticle> process_list{
+      ContinuousEnergyLoss(), MoveParticle()};
+
+  for (auto _ : state)
+    process_list(span);
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// Method 2M: like Method 2L, but with a list of processes fixed at compile time
+static void static_process_span_tiled(benchmark::State& state) {
+  auto stack = setup_stack();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const StaticProcessList<ContinuousEnergyLoss, MoveParticle> process_list{
+      ContinuousEnergyLoss(), MoveParticle()};
+
+  for (auto _ : state)
+    process_list.tiled(span);
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// Method 2N: like Method 2A, but each process picks the per-particle or the span
+// version depending on the span size, with thresholds calibrated at startup
+static void variant_process_span_hybrid(benchmark::State& state) {
+  auto stack = setup_stack();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const Hybrid<ContinuousEnergyLoss> eloss;
+  const Hybrid<MoveParticle> move;
+  ProcessList process_list;
+  process_list.emplace_back(eloss);
+  process_list.emplace_back(move);
+
+  for (auto _ : state)
+    for (const auto& process : process_list)
+      visit([&span](auto& proc) { proc(span); }, process);
+  state.SetItemsProcessed(state.iterations() * span.size());
+  state.counters["eloss_threshold"] = eloss.threshold;
+  state.counters["move_threshold"] = move.threshold;
+}
+
+// only a few particles per step reach an expensive process; arguments are the number
+// of particles per step and the minimum batch size, where 0 means no batching, and
+// batches are flushed after at most 16 steps
+static void batched_process(benchmark::State& state) {
+  auto stack = setup_stack();
+  const std::size_t n = state.range(0);
+  const std::size_t min_batch = state.range(1);
+
+  const ProcessVariant process = ContinuousEnergyLoss();
+  BatchingStage stage(process, min_batch, 16);
+  std::vector<Particle> out;
+
+  std::size_t calls = 0;
+  for (auto _ : state) {
+    ParticleSpan span(stack.data(), stack.data() + n);
+    if (min_batch == 0) {
+      visit([&span](auto& proc) { proc(span); }, process);
+      ++calls;
+    } else {
+      stage.push(span);
+      if (stage.end_step(out))
+        out.clear();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  if (min_batch > 0) {
+    const auto& stats = stage.stats();
+    calls = stats.calls;
+    state.counters["latency"] = double(stats.latency) / std::max<std::size_t>(1, stats.particles);
+  }
+  state.counters["calls_per_step"] = double(calls) / state.iterations();
+  state.counters["particles_per_call"] = double(state.iterations() * n) / std::max<std::size_t>(1, calls);
+}
+
+// Method 2P: like Method 2A, but processes which do not depend on each other according
+// to their field access declarations run concurrently; argument is the number of threads
+static void concurrent_variant_process_span(benchmark::State& state) {
+  auto stack = setup_stack(1 << 20);
+
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  ProcessList process_list;
+  process_list.emplace_back(ContinuousEnergyLoss());
+  process_list.emplace_back(MoveParticle());
+  const ProcessGraph graph(process_list);
+
+  ThreadPool pool(state.range(0));
+  for (auto _ : state)
+    concurrent_process(pool, span, process_list, graph);
+  state.SetItemsProcessed(state.iterations() * span.size());
+  state.counters["levels"] = graph.levels().size();
+}
+
+// like filtered_energy_loss, but only the fields declared by the process are gathered
+// and scattered
+template <int Percent>
+static void filtered_energy_loss_declared(benchmark::State& state) {
+  auto stack = setup_selection_stack<Percent>();
+
+  ParticleSpan span(stack.data(), stack.data() + state.range(0));
+
+  const auto proton = pid_from_pdg(2212);
+  const ContinuousEnergyLoss eloss;
+  FilteredSpan filtered;
+  for (auto _ : state) {
+    filtered.select(span, span.pid() == proton);
+    filtered.apply(eloss, eloss.reads, eloss.writes);
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// two observers after MoveParticle, which share the particles through read-only
+// spans; with 2 threads they run concurrently, with 1 thread one after the other
+static void concurrent_observers(benchmark::State& state) {
+  auto stack = setup_stack(1 << 20);
+  for (std::size_t i = 0; i < stack.size(); ++i)
+    stack[i].e() = i % 1000;
+
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  EnergyHistogram histogram(0, 1000, 100);
+  PositionSummary summary;
+  ThreadPool pool(state.range(0));
+  for (auto _ : state) {
+    move_particle(span);
+    const ConstParticleSpan view = span;
+    pool.parallel_for(2, [&](std::size_t k) {
+      if (k == 0)
+        histogram(view);
+      else
+        summary(view);
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// headline number: end-to-end synthetic shower, from one primary until the stack is
+// empty; arguments are the primary energy in units of the energy cut, and the span
+// size, where 0 means the whole stack in each step
+static void cascade_shower(benchmark::State& state) {
+  const float energy = state.range(0);
+  const std::size_t span_size = state.range(1);
+
+  ParticleStack stack;
+  Cascade<WholeStackPolicy> whole(synthetic_shower_processes(), 1.0f);
+  Cascade<FixedSpanPolicy> fixed(synthetic_shower_processes(), 1.0f, {span_size});
+
+  CascadeStats stats;
+  for (auto _ : state) {
+    stack.assign(1, make_primary(energy));
+    if (span_size == 0)
+      stats = whole.run(stack);
+    else
+      stats = fixed.run(stack);
+  }
+  state.SetItemsProcessed(state.iterations() * stats.particle_steps);
+  state.counters["steps"] = stats.steps;
+  state.counters["particle_steps"] = stats.particle_steps;
+  state.counters["peak_stack"] = stats.peak_stack_size;
+  state.counters["peak_bytes"] = stats.peak_bytes;
+  state.counters["avg_span"] = stats.average_span_size();
+}
+
+// like cascade_shower with the whole stack in each step, but out of place, on a
+// generational double-buffered stack; arguments are the primary energy in units of
+// the energy cut and the number of threads
+static void generational_shower(benchmark::State& state) {
+  const Particle primary = make_primary(state.range(0));
+
+  ThreadPool pool(state.range(1));
+  GenerationalStack stack;
+  GenerationalCascade<> cascade(pool, synthetic_shower_processes(), 1.0f);
+
+  CascadeStats stats;
+  for (auto _ : state) {
+    stack.assign(&primary, &primary + 1);
+    stats = cascade.run(stack);
+  }
+  state.SetItemsProcessed(state.iterations() * stats.particle_steps);
+  state.counters["steps"] = stats.steps;
+  state.counters["particle_steps"] = stats.particle_steps;
+  state.counters["peak_stack"] = stats.peak_stack_size;
+}
+
+// like cascade_shower, with the memory-bounded policy; arguments are the primary
+// energy in units of the energy cut and the memory budget in KiB; the byte cap is
+// four times the budget
+static void bounded_shower(benchmark::State& state) {
+  const Particle primary = make_primary(state.range(0));
+  const std::size_t budget = state.range(1) * 1024;
+
+  ParticleStack stack;
+  Cascade<MemoryBoundedPolicy> cascade(synthetic_shower_processes(), 1.0f, {budget}, 4 * budget);
+
+  CascadeStats stats;
+  for (auto _ : state) {
+    stack.assign(1, primary);
+    stats = cascade.run(stack);
+  }
+  state.SetItemsProcessed(state.iterations() * stats.particle_steps);
+  state.counters["steps"] = stats.steps;
+  state.counters["peak_bytes"] = stats.peak_bytes;
+  state.counters["peak_capacity"] = stats.peak_capacity_bytes;
+  state.counters["avg_span"] = stats.average_span_size();
+}
+
+// like cascade_shower with the whole stack in each step, with a disk spill; arguments
+// are the primary energy in units of the energy cut and the RAM limit of the stack in
+// KiB; spill and refill rates are in bytes per second
+static void spilled_shower(benchmark::State& state) {
+  const Particle primary = make_primary(state.range(0));
+  const std::size_t max_particles = state.range(1) * 1024 / sizeof(Particle);
+
+  ParticleStack stack;
+  Cascade<WholeStackPolicy> cascade(synthetic_shower_processes(), 1.0f);
+  ParticleSpill spill(max_particles, 16384);
+
+  CascadeStats stats;
+  for (auto _ : state) {
+    stack.assign(1, primary);
+    stats = cascade.run(stack, spill);
+  }
+  const auto& spill_stats = spill.stats();
+  state.SetItemsProcessed(state.iterations() * stats.particle_steps);
+  state.counters["peak_stack"] = stats.peak_stack_size;
+  state.counters["spilled"] = double(spill_stats.spilled) / state.iterations();
+  if (spill_stats.spilled > 0) {
+    state.counters["spill_rate"] = spill_stats.spilled * sizeof(Particle) / spill_stats.spill_time;
+    state.counters["refill_rate"] = spill_stats.refilled * sizeof(Particle) / spill_stats.refill_time;
+  }
+}
+
+// four uniforms per particle, from the counter-based generator for the whole span
+static void rng_philox_span(benchmark::State& state) {
+  auto stack = setup_stack(state.range(0));
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  const Philox rng(1);
+  Eigen::Array<float, Eigen::Dynamic, 4> u;
+  std::uint32_t step = 0;
+  for (auto _ : state) {
+    rng.uniform(span, 0, step++, u);
+    benchmark::DoNotOptimize(u.data());
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
+// ... and from std::mt19937, particle by particle
+static void rng_mt19937_one(benchmark::State& state) {
+  auto stack = setup_stack(state.range(0));
+  ParticleSpan span(stack.data(), stack.data() + stack.size());
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> dist;
+  Eigen::Array<float, Eigen::Dynamic, 4> u(span.size(), 4);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < span.size(); ++i)
+      for (int w = 0; w < 4; ++w)
+        u(i, w) = dist(rng);
+    benchmark::DoNotOptimize(u.data());
+  }
+  state.SetItemsProcessed(state.iterations() * span.size());
+}
+
 BENCHMARK(process_one)->RangeMultiplier(2)->Range(1, 10000);
 BENCHMARK(process_span)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_fixed, 8)->DenseRange(1, 64);
+BENCHMARK_TEMPLATE(process_span_fixed, 16)->DenseRange(1, 64);
+BENCHMARK(process_span_soa)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_aosoa, 4)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_aosoa, 8)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_aosoa, 16)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(process_one_padded)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(process_span_padded)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_simd, 4)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_simd, 8)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_simd, 16)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_log, LogAccuracy::low)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_log, LogAccuracy::medium)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_log, LogAccuracy::full)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_soa_log, LogAccuracy::low)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_soa_log, LogAccuracy::medium)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(process_span_soa_log, LogAccuracy::full)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(log_accuracy, FastLog<5>);
+BENCHMARK_TEMPLATE(log_accuracy, FastLog<7>);
+BENCHMARK_TEMPLATE(log_accuracy, FastLog<9>);
+BENCHMARK_TEMPLATE(log_accuracy, StdLog);
+BENCHMARK_TEMPLATE(charge_span, false)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(charge_span, true)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(process_span_realistic)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(energy_loss_only, false)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(energy_loss_only, true)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(move_particle_only, false)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(move_particle_only, true)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
 BENCHMARK(process_span_no_eigen)->RangeMultiplier(2)->Range(1, 10000);
 BENCHMARK(variant_process_one)->RangeMultiplier(2)->Range(1, 10000);
 BENCHMARK(variant_process_span)->RangeMultiplier(2)->Range(1, 10000);
-BENCHMARK(variant_process_span_no_eigen)->RangeMultiplier(2)->Range(1, 10000);
\ No newline at end of file
+BENCHMARK(variant_process_span_no_eigen)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(variant_process_span_partitioned)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(variant_process_span_hybrid)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(static_process_one)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(static_process_span_tiled)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(filtered_energy_loss, 10)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(filtered_energy_loss, 50)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(filtered_energy_loss, 90)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(filtered_energy_loss_declared, 10)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(filtered_energy_loss_declared, 50)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(filtered_energy_loss_declared, 90)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(masked_energy_loss, 10)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(masked_energy_loss, 50)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(masked_energy_loss, 90)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK_TEMPLATE(compact_stack, true)->Arg(1)->Arg(5)->Arg(10)->Arg(25)->Arg(50);
+BENCHMARK_TEMPLATE(compact_stack, false)->Arg(1)->Arg(5)->Arg(10)->Arg(25)->Arg(50);
+BENCHMARK(step_with_secondaries)->ArgsProduct({{1 << 10, 1 << 13, 1 << 16}, {0, 1, 2, 4}});
+BENCHMARK(parallel_variant_process_span)->Apply(thread_scaling_args)->UseRealTime();
+BENCHMARK(skewed_process_span)->Apply(skewed_args)->UseRealTime();
+BENCHMARK_TEMPLATE(variant_process_span_tiled, 0)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(variant_process_span_tiled, l1_chunk_size)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(variant_process_span_tiled, l2_chunk_size)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK(batched_process)->ArgsProduct({{1, 4, 16, 64}, {0, 64, 256}});
+BENCHMARK(concurrent_variant_process_span)->DenseRange(1, 2)->UseRealTime();
+BENCHMARK(concurrent_observers)->DenseRange(1, 2)->UseRealTime();
+BENCHMARK(compact_stack_parallel)->Arg(1)->Arg(5)->Arg(10)->Arg(25)->Arg(50)->UseRealTime();
+BENCHMARK(cascade_shower)->ArgsProduct({{1 << 10, 1 << 14, 1 << 18}, {0, 256, 4096}});
+BENCHMARK(generational_shower)->ArgsProduct({{1 << 10, 1 << 14, 1 << 18}, {1, 2, 4}})->UseRealTime();
+BENCHMARK(bounded_shower)->ArgsProduct({{1 << 14, 1 << 18}, {64, 1024, 16384}});
+BENCHMARK(spilled_shower)->ArgsProduct({{1 << 18}, {1024, 4096, 1 << 16}});
+BENCHMARK(rng_philox_span)->RangeMultiplier(2)->Range(1, 10000);
+BENCHMARK(rng_mt19937_one)->RangeMultiplier(2)->Range(1, 10000);